@@ -49,6 +49,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <algorithm>
 #include <array>
 #include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <string>
 #include <string_view>
@@ -57,24 +59,215 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "AgSsa.h"
 #include "visa.h"
 
+#include "ivi_attribute.h"
+#include "ivi_deferred_execution.h"
 #include "ivi_inner_session.h"
+#include "ivi_operation.h"
+#include "ivi_options.h"
+#include "ivi_pipeline.h"
+#include "ivi_result_log.h"
+#include "ivi_scpi.h"
+#include "ivi_session_pool.h"
+#include "ivi_spurs.h"
+#include "ivi_state.h"
+#include "ivi_stream.h"
 
 namespace AgSsa {
 
 enum class AgSsaModel : ViUInt32 { Common = 0, E5052B };
 
+namespace Attribute {
+
+template <typename ValueType>
+ViStatus Set(CIviInnerSession &session, ViConstString repCap, ViAttr id,
+             ValueType value) noexcept {
+  auto &cache = session.AttributeCache;
+  if (cache.Contains(repCap, id, value)) return VI_SUCCESS;
+  ViStatus status{};
+  if constexpr (std::is_same_v<ValueType, ViBoolean>) {
+    status = session.Invoke("AgSsa_SetAttributeViBoolean",
+                            AgSsa_SetAttributeViBoolean, session.Handle, repCap,
+                            id, value);
+  } else if constexpr (std::is_same_v<ValueType, ViInt32>) {
+    status = session.Invoke("AgSsa_SetAttributeViInt32",
+                            AgSsa_SetAttributeViInt32, session.Handle, repCap,
+                            id, value);
+  } else {
+    static_assert(std::is_same_v<ValueType, ViReal64>,
+                  "Attribute type is not supported!");
+    status = session.Invoke("AgSsa_SetAttributeViReal64",
+                            AgSsa_SetAttributeViReal64, session.Handle, repCap,
+                            id, value);
+  }
+  if (status == VI_SUCCESS) {
+    cache.Store(repCap, id, value);
+  } else {
+    cache.Invalidate(repCap, id);
+  }
+  return status;
+}
+
+// Reads the attribute from the instrument, bypassing the cache.
+template <typename ValueType>
+ViStatus Read(CIviInnerSession &session, ViConstString repCap, ViAttr id,
+              ValueType *value) noexcept {
+  ViStatus status{};
+  if constexpr (std::is_same_v<ValueType, ViBoolean>) {
+    status = session.Invoke("AgSsa_GetAttributeViBoolean",
+                            AgSsa_GetAttributeViBoolean, session.Handle, repCap,
+                            id, value);
+  } else if constexpr (std::is_same_v<ValueType, ViInt32>) {
+    status = session.Invoke("AgSsa_GetAttributeViInt32",
+                            AgSsa_GetAttributeViInt32, session.Handle, repCap,
+                            id, value);
+  } else {
+    static_assert(std::is_same_v<ValueType, ViReal64>,
+                  "Attribute type is not supported!");
+    status = session.Invoke("AgSsa_GetAttributeViReal64",
+                            AgSsa_GetAttributeViReal64, session.Handle, repCap,
+                            id, value);
+  }
+  return status;
+}
+
+template <typename ValueType>
+ViStatus Get(CIviInnerSession &session, ViConstString repCap, ViAttr id,
+             ValueType *value) noexcept {
+  auto &cache = session.AttributeCache;
+  if (cache.Lookup(repCap, id, *value)) return VI_SUCCESS;
+  auto status = Read(session, repCap, id, value);
+  if (status == VI_SUCCESS) cache.StoreRead(repCap, id, *value);
+  return status;
+}
+
+// Writes several attributes described by CIviAttribute descriptors with a
+// single status check, e.g. Set<CBand, CStartOffset>(session, band, start).
+// Values the cache already holds are skipped.
+template <typename... Descriptors>
+ViStatus Set(CIviInnerSession &session,
+             const typename Descriptors::ValueType &... values) noexcept {
+  auto *const batch = session.Recording.load(std::memory_order_relaxed);
+  if (batch != nullptr) {
+    return IviAttribute::Record<Descriptors...>(
+        [batch](std::string_view command, auto raw) {
+          batch->Add(command, raw);
+        },
+        values...);
+  }
+  return IviAttribute::Set<Descriptors...>(
+      [&session](ViConstString repCap, ViAttr id, auto raw) {
+        return Set<decltype(raw)>(session, repCap, id, raw);
+      },
+      values...);
+}
+
+template <typename... Descriptors>
+ViStatus Get(CIviInnerSession &session,
+             typename Descriptors::ValueType &... values) noexcept {
+  return IviAttribute::Get<Descriptors...>(
+      [&session](ViConstString repCap, ViAttr id, auto &raw) {
+        return Get(session, repCap, id, &raw);
+      },
+      values...);
+}
+
+}  // namespace Attribute
+
+class CAgSsaIo {
+ public:
+  static constexpr ViAttr QueryInstrumentStatus{
+      AGSSA_ATTR_QUERY_INSTRUMENT_STATUS};
+  static ViStatus Write(CIviInnerSession &session,
+                        ViConstString command) noexcept {
+    session.CountBytes("AgSsa_SystemWriteString", std::strlen(command));
+    return session.Invoke("AgSsa_SystemWriteString", AgSsa_SystemWriteString,
+                          session.Handle, command);
+  }
+  static ViStatus Read(CIviInnerSession &session, ViChar *buf, ViInt64 size,
+                       ViInt64 *retSize) noexcept {
+    auto status = session.Invoke("AgSsa_viRead", AgSsa_viRead, session.Handle,
+                                 size, buf, retSize);
+    session.CountBytes("AgSsa_viRead", std::uint64_t(*retSize));
+    return status;
+  }
+  // Raw SCPI changes the instrument behind the driver's back too, so both
+  // the wrapper's and the driver's own attribute cache are dropped.
+  static void Invalidate(CIviInnerSession &session) noexcept {
+    session.Invalidate();
+    if (session.Handle == VI_NULL) return;
+    session.Invoke("AgSsa_InvalidateAllAttributes",
+                   AgSsa_InvalidateAllAttributes, session.Handle);
+  }
+  static ViStatus EnableServiceRequest(CIviInnerSession &session,
+                                       bool enabled) noexcept {
+    ViSession io{};
+    auto status = GetIoSession(session, io);
+    if (status != VI_SUCCESS) return status;
+    return session.Invoke("viEnableEvent", Visa::EnableServiceRequest, io,
+                          enabled);
+  }
+  static ViStatus WaitForServiceRequest(CIviInnerSession &session,
+                                        ViUInt32 timeout,
+                                        ViUInt16 &statusByte) noexcept {
+    ViSession io{};
+    auto status = GetIoSession(session, io);
+    if (status != VI_SUCCESS) return status;
+    return session.Invoke("viWaitOnEvent", Visa::WaitForServiceRequest, io,
+                          timeout, statusByte);
+  }
+  static ViStatus ReadStatusByte(CIviInnerSession &session,
+                                 ViUInt16 &statusByte) noexcept {
+    ViSession io{};
+    auto status = GetIoSession(session, io);
+    if (status != VI_SUCCESS) return status;
+    return session.Invoke("viReadSTB", Visa::ReadStatusByte, io, statusByte);
+  }
+  template <typename ValueType>
+  static ViStatus GetAttribute(CIviInnerSession &session, ViConstString repCap,
+                               ViAttr id, ValueType &value) noexcept {
+    return Attribute::Read(session, repCap, id, &value);
+  }
+  template <typename ValueType>
+  static ViStatus SetAttribute(CIviInnerSession &session, ViConstString repCap,
+                               ViAttr id, ValueType value) noexcept {
+    return Attribute::Set(session, repCap, id, value);
+  }
+  // Defined after the facades, whose settings it reads back.
+  static ViStatus CaptureSettings(
+      CIviInnerSession &session,
+      CIviAttributeCache::CSnapshot &settings) noexcept;
+
+ private:
+  static ViStatus GetIoSession(CIviInnerSession &session,
+                               ViSession &io) noexcept {
+    return session.Invoke("AgSsa_GetAttributeViSession",
+                          AgSsa_GetAttributeViSession, session.Handle, nullptr,
+                          AGSSA_ATTR_SYSTEM_IO_SESSION, &io);
+  }
+};
+
+using CAgSsaOperation = CIviOperation<CAgSsaIo>;
+using CAgSsaState = CIviState<CAgSsaIo>;
+using CAgSsaDeferredExecution = CIviDeferredExecution<CAgSsaIo>;
+
 namespace Utility {
 
 class CAgSsaUtility : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
 
  public:
-  auto Reset() const noexcept { return AgSsa_reset(m_Session); }
-  auto ClearError() const noexcept { return AgSsa_ClearError(m_Session); }
+  auto Reset() const noexcept {
+    m_InnerSession.Revert();
+    return Invoke("AgSsa_reset", AgSsa_reset, m_Session);
+  }
+  auto ClearError() const noexcept {
+    return Invoke("AgSsa_ClearError", AgSsa_ClearError, m_Session);
+  }
   template <ViInt32 size>
   auto GerError(ViStatus &code, std::array<ViChar, size> &description) const
       noexcept {
-    return AgSsa_GetError(m_Session, &code, size, description.data());
+    return Invoke("AgSsa_GetError", AgSsa_GetError, m_Session, &code, size,
+                  description.data());
   }
 };
 
@@ -88,8 +281,67 @@ class CAgSsaSystem : CIviInnerSessionReference {
  public:
   auto WaitForOperationComplete(const std::chrono::milliseconds &timeout) const
       noexcept {
-    return AgSsa_SystemWaitForOperationComplete(m_Session,
-                                                ViInt32(timeout.count()));
+    return Invoke("AgSsa_SystemWaitForOperationComplete",
+                  AgSsa_SystemWaitForOperationComplete, m_Session,
+                  ViInt32(timeout.count()));
+  }
+  // ServiceRequest waits for SRQ instead of blocking inside the driver, so
+  // it returns within milliseconds of completion.
+  auto WaitForOperationComplete(const std::chrono::milliseconds &timeout,
+                                CompletionMode mode) const noexcept {
+    if (mode == CompletionMode::Polling) {
+      return WaitForOperationComplete(timeout);
+    }
+    CAgSsaOperation operation{m_InnerSession, nullptr, mode};
+    auto status = operation.Start([] { return ViStatus{VI_SUCCESS}; });
+    if (status != VI_SUCCESS) return status;
+    return operation.Wait(timeout);
+  }
+  // Runs sequence (ViStatus()) with the Configure* calls recorded into
+  // batch instead of being sent, e.g.
+  //   System.Record(batch, [&] { return Display.ConfigureMaximize(); });
+  // Settings without a SCPI header fail with VI_ERROR_NSUP_OPER.
+  template <typename Sequence>
+  auto Record(Scpi::CScpiBatch &batch, Sequence &&sequence) const noexcept {
+    return CAgSsaState::Record(m_InnerSession, batch,
+                               std::forward<Sequence>(sequence));
+  }
+  // Sends the whole batch as one program message and waits for it with a
+  // single *OPC? and SYST:ERR? check. errorCode is the first queued
+  // instrument error (0 if none); the rest of the queue is drained.
+  auto Execute(const Scpi::CScpiBatch &batch, ViInt32 &errorCode) const
+      noexcept {
+    return CAgSsaState::Execute(m_InnerSession, batch, errorCode);
+  }
+  // As above, with every queued instrument error.
+  auto Execute(const Scpi::CScpiBatch &batch,
+               std::vector<CIviDeferredError> &errors) const noexcept {
+    return CAgSsaState::Execute(m_InnerSession, batch, errors);
+  }
+  // Reads every setting the wrapper manages back from the instrument.
+  auto CaptureState(CIviStateSnapshot &snapshot) const noexcept {
+    return CAgSsaState::Capture(m_InnerSession, snapshot);
+  }
+  // Captures the state and stores it in instrument state register number
+  // too (*SAV), so it can be recalled with a single command.
+  auto SaveState(CIviStateSnapshot &snapshot, ViInt32 number,
+                 ViInt32 &errorCode) const noexcept {
+    return CAgSsaState::Save(m_InnerSession, snapshot, number, errorCode);
+  }
+  // A snapshot bound to a state register is recalled with one *RCL,
+  // otherwise only the settings differing from the cache are sent.
+  auto RecallState(const CIviStateSnapshot &snapshot, ViInt32 &errorCode) const
+      noexcept {
+    return CAgSsaState::Recall(m_InnerSession, snapshot, errorCode);
+  }
+  // Runs sequence (ViStatus()) with the driver's per-call instrument status
+  // query turned off, then drains the error queue once. Each queued error
+  // is mapped to the driver call that most likely caused it.
+  template <typename Sequence>
+  auto ExecuteDeferred(Sequence &&sequence,
+                       std::vector<CIviDeferredError> &errors) const noexcept {
+    return CAgSsaDeferredExecution::Execute(
+        m_InnerSession, std::forward<Sequence>(sequence), errors);
   }
 };
 
@@ -101,18 +353,23 @@ enum class ActiveWindowType : ViInt32 {
   PN1 = AGSSA_VAL_DISPLAY_ACTIVE_WINDOW_PN1
 };
 
+struct CMaximizeAttribute
+    : CIviAttribute<AGSSA_ATTR_DISPLAY_MAXIMIZE, bool, ViBoolean> {
+  static constexpr std::string_view Command{":DISP:MAX"};
+};
+using CActiveWindowAttribute =
+    CIviAttribute<AGSSA_ATTR_DISPLAY_ACTIVE_WINDOW, ActiveWindowType, ViInt32,
+                  CIviValueSet<ActiveWindowType::PN1>>;
+
 class CAgSsaDisplay : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
 
  public:
   auto ConfigureMaximize(bool value = true) const noexcept {
-    return AgSsa_SetAttributeViBoolean(m_Session, nullptr,
-                                       AGSSA_ATTR_DISPLAY_MAXIMIZE, value);
+    return Attribute::Set<CMaximizeAttribute>(m_InnerSession, value);
   }
   auto ConfigureActiveWindow(ActiveWindowType value) const noexcept {
-    return AgSsa_SetAttributeViInt32(
-        m_Session, nullptr, AGSSA_ATTR_DISPLAY_ACTIVE_WINDOW,
-        std::underlying_type<ActiveWindowType>::type(value));
+    return Attribute::Set<CActiveWindowAttribute>(m_InnerSession, value);
   }
 };
 
@@ -120,18 +377,20 @@ class CAgSsaDisplay : CIviInnerSessionReference {
 
 namespace Trigger {
 
+using CModeAttribute =
+    CIviAttribute<AGSSA_ATTR_TRIGGER_MODE, Display::ActiveWindowType, ViInt32>;
+using CSOPCAttribute =
+    CIviAttribute<AGSSA_ATTR_TRIGGER_SOPC_ENABLED, bool, ViBoolean>;
+
 class CAgSsaTrigger : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
 
  public:
   auto Mode(Display::ActiveWindowType value) const noexcept {
-    return AgSsa_SetAttributeViInt32(
-        m_Session, nullptr, AGSSA_ATTR_TRIGGER_MODE,
-        std::underlying_type<Display::ActiveWindowType>::type(value));
+    return Attribute::Set<CModeAttribute>(m_InnerSession, value);
   }
   auto ConfigureSOPC(bool enabled = true) const noexcept {
-    return AgSsa_SetAttributeViBoolean(
-        m_Session, nullptr, AGSSA_ATTR_TRIGGER_SOPC_ENABLED, enabled);
+    return Attribute::Set<CSOPCAttribute>(m_InnerSession, enabled);
   }
 };
 
@@ -155,69 +414,210 @@ struct CSpurData {
 };
 
 using CSpursData = std::vector<CSpurData>;
+using CSpursStream = CIviStream<CSpursData>;
+using CSpursPipeline = CIviPipeline<CSpursData>;
+using CSpursLogWriter = CIviResultLogWriter<CSpurData>;
+using CSpursLogReader = CIviResultLogReader<CSpurData>;
+using CCarrierLogWriter = CIviResultLogWriter<CCarrierData>;
+using CCarrierLogReader = CIviResultLogReader<CCarrierData>;
+
+enum class DataFormat { ASCii, Real64 };
 
 class CAgSsaApplicationPNMeasurements : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
+  // Longest spurious list block accepted, so a garbled block header cannot
+  // make the read allocate without bound.
+  inline static constexpr std::size_t SpursMax{65536};
+  mutable CSpursData m_TrackedSpurs{};
+  ViStatus ReadSpuriousListAscii(CSpursData &spursData) const noexcept {
+    ViStatus status{};
+    ViInt64 retSize{};
+    std::array<ViChar, 8192> retBuf{};
+    Scpi::CScpiRealListParser parser{};
+    CSpurData spurData{};
+    std::size_t spurParamIdx{};
+    auto spurSink = [&spursData, &spurData, &spurParamIdx](ViReal64 value) {
+      switch (spurParamIdx++) {
+        case 0:
+          spurData.Frequency = value;
+          break;
+        case 1:
+          spurData.Amplitude = value;
+          break;
+        default:
+          spurData.Unknown = value;
+          spursData.push_back(spurData);
+          spurParamIdx = 0;
+      }
+      return ViStatus{VI_SUCCESS};
+    };
+    do {
+      status = CAgSsaIo::Read(m_InnerSession, retBuf.data(), retBuf.size(),
+                              &retSize);
+      if ((status != VI_SUCCESS) && (status != VI_SUCCESS_MAX_CNT)) {
+        return status;
+      }
+      auto parseStatus =
+          parser.Consume(retBuf.data(), std::size_t(retSize), spurSink);
+      if (parseStatus != VI_SUCCESS) return parseStatus;
+    } while (status == VI_SUCCESS_MAX_CNT);
+    status = parser.Finish(spurSink);
+    if ((status == VI_SUCCESS) && (spurParamIdx != 0)) {
+      status = VI_ERROR_INV_RESPONSE;
+    }
+    return status;
+  }
+  ViStatus ReadSpuriousListBlock(CSpursData &spursData) const noexcept {
+    const auto spursNum = spursData.size();
+    bool isAligned{true};
+    auto status = Scpi::ReadDefiniteLengthBlock(
+        [this](ViChar *buf, ViInt64 size, ViInt64 *retSize) {
+          return CAgSsaIo::Read(m_InnerSession, buf, size, retSize);
+        },
+        [&spursData, &spursNum, &isAligned](std::size_t length) {
+          isAligned = (length % sizeof(CSpurData) == 0);
+          if (!isAligned || (length / sizeof(CSpurData) > SpursMax)) {
+            return static_cast<ViChar *>(nullptr);
+          }
+          try {
+            spursData.resize(spursNum + length / sizeof(CSpurData));
+          } catch (...) {
+            return static_cast<ViChar *>(nullptr);
+          }
+          return reinterpret_cast<ViChar *>(spursData.data() + spursNum);
+        });
+    if (status != VI_SUCCESS) {
+      spursData.resize(spursNum);
+      return status;
+    }
+    if (m_InnerSession.DataFormat.ByteOrder != Scpi::HostByteOrder()) {
+      Scpi::SwapBytes(reinterpret_cast<ViReal64 *>(spursData.data() + spursNum),
+                      (spursData.size() - spursNum) *
+                          (sizeof(CSpurData) / sizeof(ViReal64)));
+    }
+    return status;
+  }
 
  public:
   auto Initiate() const noexcept {
-    return AgSsa_ApplicationPhaseNoiseMeasurementsInitiate(m_Session);
+    return Invoke("AgSsa_ApplicationPhaseNoiseMeasurementsInitiate",
+                  AgSsa_ApplicationPhaseNoiseMeasurementsInitiate, m_Session);
+  }
+  // Starts the measurement and returns at once; operation tracks completion
+  // and Cancel() aborts the measurement.
+  auto InitiateAsync(CAgSsaOperation &operation,
+                     CompletionMode mode = CompletionMode::Polling) const
+      noexcept {
+    auto abort = [](CIviInnerSession &session) {
+      return session.Invoke("AgSsa_ApplicationPhaseNoiseMeasurementsAbort",
+                            AgSsa_ApplicationPhaseNoiseMeasurementsAbort,
+                            session.Handle);
+    };
+    operation = CAgSsaOperation{m_InnerSession, abort, mode};
+    return operation.Start([this] {
+      return Invoke("AgSsa_ApplicationPhaseNoiseMeasurementsInitiate",
+                    AgSsa_ApplicationPhaseNoiseMeasurementsInitiate, m_Session);
+    });
   }
   auto QueryCarrierData(CCarrierData &data) const noexcept {
     CCarrierData retData{};
     ViInt32 retSize{};
-    auto status = AgSsa_ApplicationPhaseNoiseMeasurementsGet_CarrierData(
-        m_Session, sizeof(CCarrierData), reinterpret_cast<ViReal64 *>(&retData),
-        &retSize);
+    auto status = Invoke(
+        "AgSsa_ApplicationPhaseNoiseMeasurementsGet_CarrierData",
+        AgSsa_ApplicationPhaseNoiseMeasurementsGet_CarrierData, m_Session,
+        sizeof(CCarrierData), reinterpret_cast<ViReal64 *>(&retData), &retSize);
     if ((status == VI_SUCCESS) &&
         (retSize == sizeof(CCarrierData) / sizeof(ViReal64))) {
       data = retData;
     }
     return status;
   }
+  // Real64 switches list queries to IEEE 488.2 binary blocks in host byte
+  // order, so the spurs are read straight into the caller's storage.
+  auto ConfigureDataFormat(DataFormat format) const noexcept {
+    ViStatus status{};
+    CAgSsaIo::Invalidate(m_InnerSession);
+    if (format == DataFormat::Real64) {
+      const auto byteOrder = Scpi::HostByteOrder();
+      status = CAgSsaIo::Write(m_InnerSession,
+                               (byteOrder == Scpi::ByteOrder::Swapped)
+                                   ? ":FORM:BORD SWAP;:FORM:DATA REAL"
+                                   : ":FORM:BORD NORM;:FORM:DATA REAL");
+      if (status == VI_SUCCESS) {
+        m_InnerSession.DataFormat = CIviDataFormat{true, byteOrder};
+      }
+    } else {
+      status = CAgSsaIo::Write(m_InnerSession, ":FORM:DATA ASC");
+      if (status == VI_SUCCESS) m_InnerSession.DataFormat = CIviDataFormat{};
+    }
+    return status;
+  }
+  // Window and trace select the PN measurement window and its trace.
+  template <std::size_t window = 1, std::size_t trace = 1>
   auto QuerySpuriousList(CSpursData &spursData) const noexcept {
-    auto status =
-        AgSsa_SystemWriteString(m_Session, ":CALC:PN1:TRAC1:SPUR:SLIS?");
+    static_assert(window >= 1 && trace >= 1,
+                  "Window and trace numbers start from one!");
+    static constexpr auto query{Scpi::Command(":CALC:PN", Scpi::Index<window>(),
+                                              ":TRAC", Scpi::Index<trace>(),
+                                              ":SPUR:SLIS?")};
+    auto status = CAgSsaIo::Write(m_InnerSession, query.c_str());
     if (status != VI_SUCCESS) return status;
-    ViInt64 retSize{};
-    std::array<ViChar, 8192> retBuf{};
-    std::string retString;
-    do {
-      status = AgSsa_viRead(m_Session, retBuf.size(), retBuf.data(), &retSize);
-      retString += std::string(retBuf.data(), std::size_t(retSize));
-    } while (status == VI_SUCCESS_MAX_CNT);
+    if (m_InnerSession.DataFormat.IsReal64) {
+      return ReadSpuriousListBlock(spursData);
+    }
+    return ReadSpuriousListAscii(spursData);
+  }
+  // Measures sweepsNum times back to back: each sweep is initiated right
+  // after the previous spurious list is transferred, and process runs on it
+  // while the next sweep is in progress. Process is
+  // ViStatus(const CSpursData &, std::size_t sweepIdx).
+  template <typename Process>
+  auto QuerySpuriousList(CSpursPipeline &pipeline, std::size_t sweepsNum,
+                         const std::chrono::milliseconds &timeout,
+                         Process &&process) const noexcept {
+    return pipeline.Run(
+        sweepsNum, [this] { return Initiate(); },
+        [this, &timeout] {
+          return Invoke("AgSsa_SystemWaitForOperationComplete",
+                        AgSsa_SystemWaitForOperationComplete, m_Session,
+                        ViInt32(timeout.count()));
+        },
+        [this](CSpursData &spursData) {
+          spursData.clear();
+          return QuerySpuriousList(spursData);
+        },
+        std::forward<Process>(process));
+  }
+  // Queries the spurious list and reports to sink only what changed since
+  // the previous call with the same tracker.
+  template <typename Sink>
+  auto TrackSpuriousList(Spurs::CSpurTracker &tracker, Sink &&sink) const
+      noexcept {
+    m_TrackedSpurs.clear();
+    auto status = QuerySpuriousList(m_TrackedSpurs);
     if (status != VI_SUCCESS) return status;
-    auto splitSeparatedString = [](const std::string &unsplitted,
-                                   const std::string &separator) {
-      std::vector<std::string> splitted{};
-      std::string::size_type start{};
-      std::string::size_type index = unsplitted.find(separator);
-      while (index != std::string::npos) {
-        splitted.push_back(unsplitted.substr(start, index));
-        index += separator.length();
-        start += index;
-        index = unsplitted.substr(start).find(separator);
-      };
-      splitted.push_back(unsplitted.substr(start));
-      return splitted;
-    };
-    auto splittedString = splitSeparatedString(retString, ",");
-    [&spursData, &splittedString] {
-      CSpurData spurData;
-      auto spurParamsNum{sizeof(CSpurData) / sizeof(ViReal64)};
-      for (std::size_t idx{}; idx < splittedString.size();
-           idx += spurParamsNum) {
-        std::string::size_type sz;
-        spurData.Frequency = std::stod(splittedString[idx], &sz);
-        spurData.Amplitude = std::stod(splittedString[idx + 1], &sz);
-        spurData.Unknown = std::stod(splittedString[idx + 2], &sz);
-        spursData.push_back(spurData);
-      }
-    }();
-    return status;
+    return tracker.Update(m_TrackedSpurs, sink);
+  }
+  // Measures sweep after sweep on the stream's own I/O thread: each sweep
+  // is initiated and waited for before its spurious list is queried, so
+  // every frame belongs to a new sweep.
+  auto StartStreaming(CSpursStream &stream,
+                      const std::chrono::milliseconds &timeout) const
+      noexcept {
+    return stream.Start([this, timeout](CSpursData &spursData) {
+      spursData.clear();
+      auto status = Initiate();
+      if (status != VI_SUCCESS) return status;
+      status = Invoke("AgSsa_SystemWaitForOperationComplete",
+                      AgSsa_SystemWaitForOperationComplete, m_Session,
+                      ViInt32(timeout.count()));
+      if (status != VI_SUCCESS) return status;
+      return QuerySpuriousList(spursData);
+    });
   }
   auto Abort() const noexcept {
-    return AgSsa_ApplicationPhaseNoiseMeasurementsAbort(m_Session);
+    return Invoke("AgSsa_ApplicationPhaseNoiseMeasurementsAbort",
+                  AgSsa_ApplicationPhaseNoiseMeasurementsAbort, m_Session);
   }
 };
 
@@ -227,14 +627,19 @@ namespace Measurement {
 
 namespace Spurious {
 
+struct CPowerAttribute
+    : CIviAttribute<
+          AGSSA_ATTR_APPLICATION_PHASENOISE_MEASUREMENT_SPURIOUS_POWER, bool,
+          ViBoolean> {
+  static constexpr ViConstString RepCap{"Measurement1"};
+};
+
 class CAgSsaApplicationPNMeasurementSpurious : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
 
  public:
   auto ConfigurePower(bool value = true) const noexcept {
-    return AgSsa_SetAttributeViBoolean(
-        m_Session, "Measurement1",
-        AGSSA_ATTR_APPLICATION_PHASENOISE_MEASUREMENT_SPURIOUS_POWER, value);
+    return Attribute::Set<CPowerAttribute>(m_InnerSession, value);
   }
 };
 
@@ -244,38 +649,36 @@ class CAgSsaApplicationPNMeasurement : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
 
  public:
-  Spurious::CAgSsaApplicationPNMeasurementSpurious const Spurious{m_Session};
+  Spurious::CAgSsaApplicationPNMeasurementSpurious const Spurious{
+      m_InnerSession};
 };
 
 }  // namespace Measurement
 
 namespace Aquisition {
 
+struct CCorrelationAttribute
+    : CIviAttribute<AGSSA_ATTR_APPLICATION_PHASENOISE_ACQUISITION_CORRELATION,
+                    int, ViInt32> {
+  static constexpr std::string_view Command{":SENS:PN1:CORR:COUN"};
+};
+using CSweepModeContinuousAttribute = CIviAttribute<
+    AGSSA_ATTR_APPLICATION_PHASENOISE_ACQUISITION_SWEEP_MODE_CONTINUOUS, bool,
+    ViBoolean>;
+
 class CAgSsaApplicationPNAquisition : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
 
  public:
   auto ConfigureCorrelation(int value) const noexcept {
-    return AgSsa_SetAttributeViInt32(
-        m_Session, nullptr,
-        AGSSA_ATTR_APPLICATION_PHASENOISE_ACQUISITION_CORRELATION, value);
+    return Attribute::Set<CCorrelationAttribute>(m_InnerSession, value);
   }
   auto QueryCorrelation(int &value) const noexcept {
-    ViInt32 correlation{};
-    auto status = AgSsa_GetAttributeViInt32(
-        m_Session, nullptr,
-        AGSSA_ATTR_APPLICATION_PHASENOISE_ACQUISITION_CORRELATION,
-        &correlation);
-    if (status == VI_SUCCESS) {
-      value = static_cast<int>(correlation);
-    }
-    return status;
+    return Attribute::Get<CCorrelationAttribute>(m_InnerSession, value);
   }
   auto ConfigureSweepModeContinuous(bool enabled = true) const noexcept {
-    return AgSsa_SetAttributeViBoolean(
-        m_Session, nullptr,
-        AGSSA_ATTR_APPLICATION_PHASENOISE_ACQUISITION_SWEEP_MODE_CONTINUOUS,
-        enabled);
+    return Attribute::Set<CSweepModeContinuousAttribute>(m_InnerSession,
+                                                         enabled);
   }
 };
 
@@ -283,14 +686,16 @@ class CAgSsaApplicationPNAquisition : CIviInnerSessionReference {
 
 namespace Display {
 
+using CMaximizeAttribute =
+    CIviAttribute<AGSSA_ATTR_APPLICATION_PHASENOISE_DISPLAY_MAXIMIZE, bool,
+                  ViBoolean>;
+
 class CAgSsaApplicationPNDisplay : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
 
  public:
   auto ConfigureMaximize(bool maximized = true) const noexcept {
-    return AgSsa_SetAttributeViBoolean(
-        m_Session, nullptr, AGSSA_ATTR_APPLICATION_PHASENOISE_DISPLAY_MAXIMIZE,
-        maximized);
+    return Attribute::Set<CMaximizeAttribute>(m_InnerSession, maximized);
   }
 };
 
@@ -326,96 +731,54 @@ enum class FrequencyBand : ViInt32 {
   BAND_HIGH = AGSSA_VAL_FREQUENCY_BAND_HIGH
 };
 
+using CFrequencyBandAttribute = CIviAttribute<
+    AGSSA_ATTR_APPLICATION_PHASENOISE_FREQUENCY_BAND, FrequencyBand, ViInt32,
+    CIviValueSet<FrequencyBand::BAND1, FrequencyBand::BAND2,
+                 FrequencyBand::BAND3, FrequencyBand::BAND4,
+                 FrequencyBand::BAND5, FrequencyBand::BAND6,
+                 FrequencyBand::BAND_LOW, FrequencyBand::BAND_HIGH>>;
+struct CStartOffsetAttribute
+    : CIviAttribute<
+          AGSSA_ATTR_APPLICATION_PHASENOISE_FREQUENCY_START_OFFSET,
+          FrequencyStartOffset, ViReal64,
+          CIviValueSet<FrequencyStartOffset::_1Hz, FrequencyStartOffset::_10Hz,
+                       FrequencyStartOffset::_100Hz,
+                       FrequencyStartOffset::_1kHz>> {
+  static constexpr std::string_view Command{":SENS:PN1:FREQ:STAR"};
+};
+struct CStopOffsetAttribute
+    : CIviAttribute<
+          AGSSA_ATTR_APPLICATION_PHASENOISE_FREQUENCY_STOP_OFFSET,
+          FrequencyStopOffset, ViReal64,
+          CIviValueSet<FrequencyStopOffset::_100kHz,
+                       FrequencyStopOffset::_1MHz, FrequencyStopOffset::_5MHz,
+                       FrequencyStopOffset::_10MHz, FrequencyStopOffset::_20MHz,
+                       FrequencyStopOffset::_40MHz,
+                       FrequencyStopOffset::_100MHz>> {
+  static constexpr std::string_view Command{":SENS:PN1:FREQ:STOP"};
+};
+
 class CAgSsaApplicationPNFrequency : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
 
  public:
   auto ConfigureFrequencyBand(FrequencyBand value) const noexcept {
-    return AgSsa_SetAttributeViInt32(
-        m_Session, nullptr, AGSSA_ATTR_APPLICATION_PHASENOISE_FREQUENCY_BAND,
-        std::underlying_type<FrequencyBand>::type(value));
+    return Attribute::Set<CFrequencyBandAttribute>(m_InnerSession, value);
   }
   auto QueryFrequencyBand(FrequencyBand &value) const noexcept {
-    ViInt32 rawBand{};
-    auto status = AgSsa_GetAttributeViInt32(
-        m_Session, nullptr, AGSSA_ATTR_APPLICATION_PHASENOISE_FREQUENCY_BAND,
-        &rawBand);
-    if (status == VI_SUCCESS) {
-      FrequencyBand band{std::underlying_type<FrequencyBand>::type(rawBand)};
-      status = VI_ERROR_INV_RESPONSE;
-      switch (band) {
-        case FrequencyBand::BAND1:
-        case FrequencyBand::BAND2:
-        case FrequencyBand::BAND3:
-        case FrequencyBand::BAND4:
-        case FrequencyBand::BAND5:
-        case FrequencyBand::BAND6:
-        case FrequencyBand::BAND_LOW:
-        case FrequencyBand::BAND_HIGH:
-          value = band;
-          status = VI_SUCCESS;
-          break;
-      }
-    }
-    return status;
+    return Attribute::Get<CFrequencyBandAttribute>(m_InnerSession, value);
   }
   auto ConfigureStartOffset(FrequencyStartOffset value) const noexcept {
-    auto rawFrequency = static_cast<ViReal64>(value);
-    return AgSsa_SetAttributeViReal64(
-        m_Session, nullptr,
-        AGSSA_ATTR_APPLICATION_PHASENOISE_FREQUENCY_START_OFFSET, rawFrequency);
+    return Attribute::Set<CStartOffsetAttribute>(m_InnerSession, value);
   }
   auto QueryStartOffset(FrequencyStartOffset &value) const noexcept {
-    ViReal64 rawFrequency{};
-    auto status = AgSsa_GetAttributeViReal64(
-        m_Session, nullptr,
-        AGSSA_ATTR_APPLICATION_PHASENOISE_FREQUENCY_START_OFFSET,
-        &rawFrequency);
-    if (status == VI_SUCCESS) {
-      FrequencyStartOffset frequency{
-          std::underlying_type<FrequencyStartOffset>::type(rawFrequency)};
-      status = VI_ERROR_INV_RESPONSE;
-      switch (frequency) {
-        case FrequencyStartOffset::_1Hz:
-        case FrequencyStartOffset::_10Hz:
-        case FrequencyStartOffset::_100Hz:
-        case FrequencyStartOffset::_1kHz:
-          value = frequency;
-          status = VI_SUCCESS;
-          break;
-      }
-    }
-    return status;
+    return Attribute::Get<CStartOffsetAttribute>(m_InnerSession, value);
   }
   auto ConfigureStopOffset(FrequencyStopOffset value) const noexcept {
-    auto rawFrequency = static_cast<ViReal64>(value);
-    return AgSsa_SetAttributeViReal64(
-        m_Session, nullptr,
-        AGSSA_ATTR_APPLICATION_PHASENOISE_FREQUENCY_STOP_OFFSET, rawFrequency);
+    return Attribute::Set<CStopOffsetAttribute>(m_InnerSession, value);
   }
   auto QueryStopOffset(FrequencyStopOffset &value) const noexcept {
-    ViReal64 rawFrequency{};
-    auto status = AgSsa_GetAttributeViReal64(
-        m_Session, nullptr,
-        AGSSA_ATTR_APPLICATION_PHASENOISE_FREQUENCY_STOP_OFFSET, &rawFrequency);
-    if (status == VI_SUCCESS) {
-      FrequencyStopOffset frequency{
-          std::underlying_type<FrequencyStopOffset>::type(rawFrequency)};
-      status = VI_ERROR_INV_RESPONSE;
-      switch (frequency) {
-        case FrequencyStopOffset::_100kHz:
-        case FrequencyStopOffset::_1MHz:
-        case FrequencyStopOffset::_5MHz:
-        case FrequencyStopOffset::_10MHz:
-        case FrequencyStopOffset::_20MHz:
-        case FrequencyStopOffset::_40MHz:
-        case FrequencyStopOffset::_100MHz:
-          value = frequency;
-          status = VI_SUCCESS;
-          break;
-      }
-    }
-    return status;
+    return Attribute::Get<CStopOffsetAttribute>(m_InnerSession, value);
   }
 };
 
@@ -425,15 +788,21 @@ class CAgSsaApplicationPN : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
 
  public:
+  template <std::size_t window = 1>
   auto AutoSettings() const noexcept {
-    std::string_view PN_ASET{"SENS:PS1:ASET"};
-    return AgSsa_SystemWrite(m_Session, PN_ASET.data());
-  }
-  Frequency::CAgSsaApplicationPNFrequency const Frequency{m_Session};
-  Aquisition::CAgSsaApplicationPNAquisition const Aquisition{m_Session};
-  Display::CAgSsaApplicationPNDisplay const Display{m_Session};
-  Measurement::CAgSsaApplicationPNMeasurement const Measurement{m_Session};
-  Measurements::CAgSsaApplicationPNMeasurements const Measurements{m_Session};
+    static_assert(window >= 1, "Window number starts from one!");
+    static constexpr auto command{
+        Scpi::Command("SENS:PS", Scpi::Index<window>(), ":ASET")};
+    CAgSsaIo::Invalidate(m_InnerSession);
+    return Invoke("AgSsa_SystemWrite", AgSsa_SystemWrite, m_Session,
+                  command.c_str());
+  }
+  Frequency::CAgSsaApplicationPNFrequency const Frequency{m_InnerSession};
+  Aquisition::CAgSsaApplicationPNAquisition const Aquisition{m_InnerSession};
+  Display::CAgSsaApplicationPNDisplay const Display{m_InnerSession};
+  Measurement::CAgSsaApplicationPNMeasurement const Measurement{m_InnerSession};
+  Measurements::CAgSsaApplicationPNMeasurements const Measurements{
+      m_InnerSession};
 };
 
 }  // namespace PN
@@ -442,72 +811,129 @@ class CAgSsaApplication : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
 
  public:
-  PN::CAgSsaApplicationPN const PN{m_Session};
+  PN::CAgSsaApplicationPN const PN{m_InnerSession};
 };
 
 }  // namespace Application
 
-struct CAgSsaOptions {
+inline ViStatus CAgSsaIo::CaptureSettings(
+    CIviInnerSession &session,
+    CIviAttributeCache::CSnapshot &settings) noexcept {
+  namespace PN = Application::PN;
+  return CAgSsaState::CaptureValues<
+      Display::CMaximizeAttribute, Display::CActiveWindowAttribute,
+      Trigger::CModeAttribute, Trigger::CSOPCAttribute,
+      PN::Measurement::Spurious::CPowerAttribute,
+      PN::Aquisition::CCorrelationAttribute,
+      PN::Aquisition::CSweepModeContinuousAttribute,
+      PN::Display::CMaximizeAttribute, PN::Frequency::CFrequencyBandAttribute,
+      PN::Frequency::CStartOffsetAttribute,
+      PN::Frequency::CStopOffsetAttribute>(session, settings);
+}
+
+struct CAgSsaOptions : CIviDriverOptions {
   CAgSsaOptions() = default;
   template <class COptions>
   CAgSsaOptions(const COptions &opt)
-      : Model(static_cast<AgSsaModel>(opt.Model)),
+      : CIviDriverOptions(IviOptions::DriverOptionsOf(opt)),
+        Model(static_cast<AgSsaModel>(opt.Model)),
         Simulate(opt.Simulate),
         Reset(opt.Reset),
-        idQuery(opt.idQuery) {}
+        idQuery(opt.idQuery),
+        AttributeCache(IviOptions::AttributeCacheOf(opt)) {}
   AgSsaModel Model{AgSsaModel::Common};
   bool Simulate{};
   bool Reset{};
   bool idQuery{};
+  bool AttributeCache{};
+  bool operator==(const CAgSsaOptions &other) const noexcept {
+    return (Model == other.Model) && (Simulate == other.Simulate) &&
+           (Reset == other.Reset) && (idQuery == other.idQuery) &&
+           (AttributeCache == other.AttributeCache) &&
+           CIviDriverOptions::operator==(other);
+  }
+  bool operator!=(const CAgSsaOptions &other) const noexcept {
+    return !(*this == other);
+  }
 };
 
 class CAgSsa {
-  ViSession m_Session{};
+  CIviInnerSession m_InnerSession{};
+  ViSession &m_Session{m_InnerSession.Handle};
   CAgSsaOptions m_Options{};
+  static std::string_view ModelName(AgSsaModel model) noexcept {
+    switch (model) {
+      case AgSsaModel::E5052B:
+        return "E5052B";
+      default:
+        return {};
+    }
+  }
   std::string MakeOptionsString(const CAgSsaOptions &options) {
-    using namespace std::string_literals;
-    auto opts = "Simulate="s;
     m_Options = options;
-    if (options.Simulate) {
-      opts += "true"s;
-    } else {
-      opts += "false"s;
-    }
-    if (options.Model != AgSsaModel::Common) {
-      opts += ", DriverSetup=Model="s;
-      switch (options.Model) {
-        case AgSsaModel::E5052B:
-          opts += "E5052B"s;
-          break;
-        default:
-          opts.clear();
-      }
-    }
-    return opts;
+    return IviOptions::MakeString(options, options.Simulate,
+                                  ModelName(options.Model));
   }
 
  public:
   auto Connect(const std::string &resource,
                const CAgSsaOptions &options) noexcept {
     auto optionsString = MakeOptionsString(options);
-    return AgSsa_InitWithOptions(ViRsrc(resource.data()), options.idQuery,
-                                 options.Reset, optionsString.data(),
-                                 &m_Session);
+    m_InnerSession.Revert();
+    m_InnerSession.AttributeCache.Enable(options.AttributeCache);
+    return m_InnerSession.Invoke(
+        "AgSsa_InitWithOptions", AgSsa_InitWithOptions, ViRsrc(resource.data()),
+        options.idQuery, options.Reset, optionsString.data(), &m_Session);
   }
   void Close() noexcept {
-    AgSsa_close(m_Session);
+    m_InnerSession.Invoke("AgSsa_close", AgSsa_close, m_Session);
     m_Session = 0;
+    m_InnerSession.Revert();
   }
   bool IsOpen() const noexcept { return (m_Session != 0); }
+  // Cheap liveness probe of an open session: a single status byte read,
+  // which leaves the instrument state and its queues untouched.
+  ViStatus CheckConnection() noexcept {
+    if (!IsOpen()) return VI_ERROR_CONN_LOST;
+    // A simulated session has no I/O session to lose.
+    if (m_Options.Simulate) return VI_SUCCESS;
+    ViUInt16 statusByte{};
+    return CAgSsaIo::ReadStatusByte(m_InnerSession, statusByte);
+  }
   bool IsSimulate() const noexcept { return m_Options.Simulate; }
   ViSession GetSession() const noexcept { return m_Session; }
-  Application::CAgSsaApplication const Application{m_Session};
-  Display::CAgSsaDisplay const Display{m_Session};
-  Trigger::CAgSsaTrigger const Trigger{m_Session};
-  System::CAgSsaSystem const System{m_Session};
-  Utility::CAgSsaUtility const Utility{m_Session};
+  const CIviAttributeCache::CStatistics &GetAttributeCacheStatistics() const
+      noexcept {
+    return m_InnerSession.AttributeCache.GetStatistics();
+  }
+  // Safe while other threads use the instrument. The profiler stays valid
+  // as long as the instrument; GetProfiler() is null while it is off.
+  void EnableProfiling(bool enabled = true) {
+    m_InnerSession.EnableProfiling(enabled);
+  }
+  const CIviCallProfiler *GetProfiler() const noexcept {
+    return m_InnerSession.Profiler.load(std::memory_order_acquire);
+  }
+  // Writes or reads a group of attributes given by their descriptors (the
+  // C*Attribute types next to the accessors) with a single status check.
+  template <typename... Descriptors>
+  auto SetAttributes(
+      const typename Descriptors::ValueType &... values) noexcept {
+    return Attribute::Set<Descriptors...>(m_InnerSession, values...);
+  }
+  template <typename... Descriptors>
+  auto GetAttributes(typename Descriptors::ValueType &... values) noexcept {
+    return Attribute::Get<Descriptors...>(m_InnerSession, values...);
+  }
+  Application::CAgSsaApplication const Application{m_InnerSession};
+  Display::CAgSsaDisplay const Display{m_InnerSession};
+  Trigger::CAgSsaTrigger const Trigger{m_InnerSession};
+  System::CAgSsaSystem const System{m_InnerSession};
+  Utility::CAgSsaUtility const Utility{m_InnerSession};
 };
 
+using CAgSsaPool = CIviSessionPool<CAgSsa, CAgSsaOptions>;
+
 }  // namespace AgSsa
 
 #endif  // AGSSA_WRAPPER_H
@@ -46,20 +46,277 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef AGXSAN_WRAPPER_H
 #define AGXSAN_WRAPPER_H
 
+#include <algorithm>
 #include <array>
 #include <chrono>
-#include <functional>
+#include <cstdint>
+#include <cstring>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 #include "AgXSAn.h"
 #include "visa.h"
 
+#include "ivi_attribute.h"
+#include "ivi_deferred_execution.h"
 #include "ivi_inner_session.h"
+#include "ivi_operation.h"
+#include "ivi_options.h"
+#include "ivi_pipeline.h"
+#include "ivi_result_log.h"
+#include "ivi_scheduler.h"
+#include "ivi_scpi.h"
+#include "ivi_session_pool.h"
+#include "ivi_spurs.h"
+#include "ivi_state.h"
+#include "ivi_stream.h"
 
 namespace AgXSAn {
 
 enum class AgXSAnModel : ViUInt32 { Common = 0, N9030A };
 
+namespace Attribute {
+
+template <typename ValueType>
+ViStatus Set(CIviInnerSession &session, ViConstString repCap, ViAttr id,
+             ValueType value) noexcept {
+  auto &cache = session.AttributeCache;
+  if (cache.Contains(repCap, id, value)) return VI_SUCCESS;
+  ViStatus status{};
+  if constexpr (std::is_same_v<ValueType, ViBoolean>) {
+    status = session.Invoke("AgXSAn_SetAttributeViBoolean",
+                            AgXSAn_SetAttributeViBoolean, session.Handle,
+                            repCap, id, value);
+  } else if constexpr (std::is_same_v<ValueType, ViInt32>) {
+    status = session.Invoke("AgXSAn_SetAttributeViInt32",
+                            AgXSAn_SetAttributeViInt32, session.Handle, repCap,
+                            id, value);
+  } else {
+    static_assert(std::is_same_v<ValueType, ViReal64>,
+                  "Attribute type is not supported!");
+    status = session.Invoke("AgXSAn_SetAttributeViReal64",
+                            AgXSAn_SetAttributeViReal64, session.Handle, repCap,
+                            id, value);
+  }
+  if (status == VI_SUCCESS) {
+    cache.Store(repCap, id, value);
+  } else {
+    cache.Invalidate(repCap, id);
+  }
+  return status;
+}
+
+// Reads the attribute from the instrument, bypassing the cache.
+template <typename ValueType>
+ViStatus Read(CIviInnerSession &session, ViConstString repCap, ViAttr id,
+              ValueType *value) noexcept {
+  ViStatus status{};
+  if constexpr (std::is_same_v<ValueType, ViBoolean>) {
+    status = session.Invoke("AgXSAn_GetAttributeViBoolean",
+                            AgXSAn_GetAttributeViBoolean, session.Handle,
+                            repCap, id, value);
+  } else if constexpr (std::is_same_v<ValueType, ViInt32>) {
+    status = session.Invoke("AgXSAn_GetAttributeViInt32",
+                            AgXSAn_GetAttributeViInt32, session.Handle, repCap,
+                            id, value);
+  } else {
+    static_assert(std::is_same_v<ValueType, ViReal64>,
+                  "Attribute type is not supported!");
+    status = session.Invoke("AgXSAn_GetAttributeViReal64",
+                            AgXSAn_GetAttributeViReal64, session.Handle, repCap,
+                            id, value);
+  }
+  return status;
+}
+
+template <typename ValueType>
+ViStatus Get(CIviInnerSession &session, ViConstString repCap, ViAttr id,
+             ValueType *value) noexcept {
+  auto &cache = session.AttributeCache;
+  if (cache.Lookup(repCap, id, *value)) return VI_SUCCESS;
+  auto status = Read(session, repCap, id, value);
+  if (status == VI_SUCCESS) cache.StoreRead(repCap, id, *value);
+  return status;
+}
+
+// Writes several attributes described by CIviAttribute descriptors with a
+// single status check, e.g. Set<CScale, CReference>(session, scale, ref).
+// Values the cache already holds are skipped.
+template <typename... Descriptors>
+ViStatus Set(CIviInnerSession &session,
+             const typename Descriptors::ValueType &... values) noexcept {
+  auto *const batch = session.Recording.load(std::memory_order_relaxed);
+  if (batch != nullptr) {
+    return IviAttribute::Record<Descriptors...>(
+        [batch](std::string_view command, auto raw) {
+          batch->Add(command, raw);
+        },
+        values...);
+  }
+  return IviAttribute::Set<Descriptors...>(
+      [&session](ViConstString repCap, ViAttr id, auto raw) {
+        return Set<decltype(raw)>(session, repCap, id, raw);
+      },
+      values...);
+}
+
+template <typename... Descriptors>
+ViStatus Get(CIviInnerSession &session,
+             typename Descriptors::ValueType &... values) noexcept {
+  return IviAttribute::Get<Descriptors...>(
+      [&session](ViConstString repCap, ViAttr id, auto &raw) {
+        return Get(session, repCap, id, &raw);
+      },
+      values...);
+}
+
+template <typename FunctionType, typename ValueType>
+ViStatus ApplyTable(CIviInnerSession &session, std::string_view function,
+                    CIviAttributeCache::TableFunctionType call,
+                    std::string_view bytes) noexcept;
+
+// Uploads a table through the given driver function unless the instrument
+// already holds exactly this content.
+template <typename Function, typename ValueType>
+ViStatus SetTable(CIviInnerSession &session, std::string_view function,
+                  Function &&call, ViInt32 size, ValueType *table) noexcept {
+  using FunctionType = std::decay_t<Function>;
+  auto &cache = session.AttributeCache;
+  if (cache.ContainsTable(function, table, std::size_t(size))) {
+    return VI_SUCCESS;
+  }
+  const FunctionType pointer = call;
+  auto status = session.Invoke(function, pointer, session.Handle, size, table);
+  if (status == VI_SUCCESS) {
+    cache.StoreTable(
+        function,
+        reinterpret_cast<CIviAttributeCache::TableFunctionType>(pointer),
+        &ApplyTable<FunctionType, ValueType>, table, std::size_t(size));
+  } else {
+    cache.InvalidateTable(function);
+  }
+  return status;
+}
+
+// Uploads a table shadowed by the attribute cache again.
+template <typename FunctionType, typename ValueType>
+ViStatus ApplyTable(CIviInnerSession &session, std::string_view function,
+                    CIviAttributeCache::TableFunctionType call,
+                    std::string_view bytes) noexcept {
+  std::vector<ValueType> table{};
+  try {
+    table.resize(bytes.size() / sizeof(ValueType));
+  } catch (...) {
+    return VI_ERROR_ALLOC;
+  }
+  std::memcpy(table.data(), bytes.data(), table.size() * sizeof(ValueType));
+  return SetTable(session, function, reinterpret_cast<FunctionType>(call),
+                  ViInt32(table.size()), table.data());
+}
+
+// Appends a table read back from the instrument to settings, so that
+// applying them uploads it through the given driver function.
+template <typename Function, typename ValueType>
+ViStatus CaptureTable(CIviAttributeCache::CSnapshot &settings,
+                      std::string_view function, Function &&call,
+                      const ValueType *table, std::size_t size) noexcept {
+  using FunctionType = std::decay_t<Function>;
+  const FunctionType pointer = call;
+  try {
+    settings.Tables.emplace_back(
+        function,
+        CIviAttributeCache::CTable{
+            std::string(reinterpret_cast<const char *>(table),
+                        size * sizeof(ValueType)),
+            reinterpret_cast<CIviAttributeCache::TableFunctionType>(pointer),
+            &ApplyTable<FunctionType, ValueType>});
+  } catch (...) {
+    return VI_ERROR_ALLOC;
+  }
+  return VI_SUCCESS;
+}
+
+}  // namespace Attribute
+
+class CAgXSAnIo {
+ public:
+  static constexpr ViAttr QueryInstrumentStatus{
+      AGXSAN_ATTR_QUERY_INSTRUMENT_STATUS};
+  static ViStatus Write(CIviInnerSession &session,
+                        ViConstString command) noexcept {
+    session.CountBytes("AgXSAn_SystemWriteString", std::strlen(command));
+    return session.Invoke("AgXSAn_SystemWriteString", AgXSAn_SystemWriteString,
+                          session.Handle, command);
+  }
+  static ViStatus Read(CIviInnerSession &session, ViChar *buf, ViInt64 size,
+                       ViInt64 *retSize) noexcept {
+    auto status = session.Invoke("AgXSAn_viRead", AgXSAn_viRead, session.Handle,
+                                 size, buf, retSize);
+    session.CountBytes("AgXSAn_viRead", std::uint64_t(*retSize));
+    return status;
+  }
+  // Raw SCPI changes the instrument behind the driver's back too, so both
+  // the wrapper's and the driver's own attribute cache are dropped.
+  static void Invalidate(CIviInnerSession &session) noexcept {
+    session.Invalidate();
+    if (session.Handle == VI_NULL) return;
+    session.Invoke("AgXSAn_InvalidateAllAttributes",
+                   AgXSAn_InvalidateAllAttributes, session.Handle);
+  }
+  static ViStatus EnableServiceRequest(CIviInnerSession &session,
+                                       bool enabled) noexcept {
+    ViSession io{};
+    auto status = GetIoSession(session, io);
+    if (status != VI_SUCCESS) return status;
+    return session.Invoke("viEnableEvent", Visa::EnableServiceRequest, io,
+                          enabled);
+  }
+  static ViStatus WaitForServiceRequest(CIviInnerSession &session,
+                                        ViUInt32 timeout,
+                                        ViUInt16 &statusByte) noexcept {
+    ViSession io{};
+    auto status = GetIoSession(session, io);
+    if (status != VI_SUCCESS) return status;
+    return session.Invoke("viWaitOnEvent", Visa::WaitForServiceRequest, io,
+                          timeout, statusByte);
+  }
+  static ViStatus ReadStatusByte(CIviInnerSession &session,
+                                 ViUInt16 &statusByte) noexcept {
+    ViSession io{};
+    auto status = GetIoSession(session, io);
+    if (status != VI_SUCCESS) return status;
+    return session.Invoke("viReadSTB", Visa::ReadStatusByte, io, statusByte);
+  }
+  template <typename ValueType>
+  static ViStatus GetAttribute(CIviInnerSession &session, ViConstString repCap,
+                               ViAttr id, ValueType &value) noexcept {
+    return Attribute::Read(session, repCap, id, &value);
+  }
+  template <typename ValueType>
+  static ViStatus SetAttribute(CIviInnerSession &session, ViConstString repCap,
+                               ViAttr id, ValueType value) noexcept {
+    return Attribute::Set(session, repCap, id, value);
+  }
+  // Defined after the facades, whose settings it reads back.
+  static ViStatus CaptureSettings(
+      CIviInnerSession &session,
+      CIviAttributeCache::CSnapshot &settings) noexcept;
+
+ private:
+  static ViStatus GetIoSession(CIviInnerSession &session,
+                               ViSession &io) noexcept {
+    return session.Invoke("AgXSAn_GetAttributeViSession",
+                          AgXSAn_GetAttributeViSession, session.Handle, nullptr,
+                          AGXSAN_ATTR_SYSTEM_IO_SESSION, &io);
+  }
+};
+
+using CAgXSAnOperation = CIviOperation<CAgXSAnIo>;
+using CAgXSAnState = CIviState<CAgXSAnIo>;
+using CAgXSAnDeferredExecution = CIviDeferredExecution<CAgXSAnIo>;
+
 namespace SA {
 
 namespace SpuriousEmissions {
@@ -89,6 +346,11 @@ struct CSweepPointsAutoEnabledTable : CTable<ViBoolean, size> {
   using CTable<ViBoolean, size>::CTable;
 };
 
+template <ViInt32 size>
+struct CSweepPointsTable : CTable<ViInt32, size> {
+  using CTable<ViInt32, size>::CTable;
+};
+
 template <ViInt32 size>
 struct CPeakThresholdTable : CTable<ViReal64, size> {
   using CTable<ViReal64, size>::CTable;
@@ -119,6 +381,24 @@ struct CAbsoluteAmplitudeLimitAutoEnabledTable : CTable<ViBoolean, size> {
   using CTable<ViBoolean, size>::CTable;
 };
 
+// Every column of the range table as the instrument currently holds it.
+template <ViInt32 size>
+struct CRangeTableState {
+  CEnabledTable<size> Enabled{};
+  CFrequencyTable<size> StartFrequency{};
+  CFrequencyTable<size> StopFrequency{};
+  CAbsoluteAmplitudeLimitTable<size> StartAbsoluteAmplitudeLimit{};
+  CAbsoluteAmplitudeLimitTable<size> StopAbsoluteAmplitudeLimit{};
+  CAbsoluteAmplitudeLimitAutoEnabledTable<size>
+      StopAbsoluteAmplitudeLimitAutoEnabled{};
+  CResolutionTable<size> Resolution{};
+  CAttenuationTable<size> Attenuation{};
+  CPeakThresholdTable<size> PeakThreshold{};
+  CSweepPointsTable<size> SweepPoints{};
+  CSweepPointsAutoEnabledTable<size> SweepPointsAutoEnabled{};
+  CSweepTimeTable<size> SweepTime{};
+};
+
 struct CSpurData {
   ViReal64 Number;
   ViReal64 Range;
@@ -130,6 +410,30 @@ struct CSpurData {
 
 using CSpursData = std::vector<CSpurData>;
 
+template <typename ElementType>
+class CView {
+  ElementType *m_Data{};
+  std::size_t m_Size{};
+
+ public:
+  CView() = default;
+  CView(ElementType *data, std::size_t size) : m_Data{data}, m_Size{size} {}
+  ElementType *data() const noexcept { return m_Data; }
+  std::size_t size() const noexcept { return m_Size; }
+  bool empty() const noexcept { return m_Size == 0; }
+  ElementType *begin() const noexcept { return m_Data; }
+  ElementType *end() const noexcept { return m_Data + m_Size; }
+  ElementType &operator[](std::size_t idx) const noexcept {
+    return m_Data[idx];
+  }
+};
+
+using CSpursView = CView<const CSpurData>;
+using CSpursStream = CIviStream<CSpursData>;
+using CSpursPipeline = CIviPipeline<CSpursData>;
+using CSpursLogWriter = CIviResultLogWriter<CSpurData>;
+using CSpursLogReader = CIviResultLogReader<CSpurData>;
+
 struct AgXSAnConstatns {
   inline static constexpr ViInt32 RangeTableMax{20};
 };
@@ -148,6 +452,9 @@ using CAgXSAnSweepTimeTable = CSweepTimeTable<AgXSAnConstatns::RangeTableMax>;
 using CAgXSAnResolutionTable = CResolutionTable<AgXSAnConstatns::RangeTableMax>;
 using CAgXSAnAbsoluteAmplitudeLimitAutoEnabledTable =
     CAbsoluteAmplitudeLimitAutoEnabledTable<AgXSAnConstatns::RangeTableMax>;
+using CAgXSAnSweepPointsTable =
+    CSweepPointsTable<AgXSAnConstatns::RangeTableMax>;
+using CAgXSAnRangeTableState = CRangeTableState<AgXSAnConstatns::RangeTableMax>;
 
 struct AgXSAnPresets {
   struct Display {
@@ -227,45 +534,154 @@ namespace Trace {
 
 class CAgXSAnSASpuriousEmissionsTrace : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
-  using GetSpuriousResultsFunctorType =
-      std::function<ViStatus(ViInt32, ViReal64 *, ViInt32 *)>;
-  auto GetSpuriousResults(Types::CSpursData &spursData,
-                          const GetSpuriousResultsFunctorType &functor) const
+  // The driver returns the spurs count ahead of the records. It is read into
+  // the last field of a spare leading record, so the records land in
+  // m_Buffer[1..] and are used in place. The buffer is shared by every caller
+  // of the session, see ReadSpuriousResults.
+  mutable Types::CSpursData m_Buffer{};
+  template <typename Functor>
+  auto GetSpuriousResults(Types::CSpursView &spursView, Functor &&functor) const
       noexcept {
     using namespace Types;
-    const ViInt32 querySpursNum{256};
-    const ViInt32 spurParamsNum{sizeof(CSpurData) / sizeof(ViReal64)};
-    const ViInt32 queryBufSize{querySpursNum * spurParamsNum};
-    ViReal64 buf[queryBufSize]{};
+    static_assert(std::is_trivially_copyable_v<CSpurData> &&
+                      (sizeof(CSpurData) % sizeof(ViReal64) == 0),
+                  "Spur record must be a plain array of ViReal64!");
+    const std::size_t querySpursNum{256};
+    const std::size_t spurParamsNum{sizeof(CSpurData) / sizeof(ViReal64)};
+    auto fetchBuf = [this, spurParamsNum] {
+      return reinterpret_cast<ViReal64 *>(m_Buffer.data()) + spurParamsNum - 1;
+    };
+    auto fetchBufSize = [this, spurParamsNum] {
+      return (m_Buffer.size() - 1) * spurParamsNum + 1;
+    };
+    try {
+      if (m_Buffer.size() < querySpursNum + 1) {
+        m_Buffer.resize(querySpursNum + 1);
+      }
+    } catch (...) {
+      return ViStatus{VI_ERROR_ALLOC};
+    }
     ViInt32 retBufSize{};
-    auto status = functor(queryBufSize, buf, &retBufSize);
-    if (status == VI_SUCCESS) {
-      const ViInt32 retSpursNum{retBufSize / spurParamsNum};
-      spursData.reserve(std::size_t(retSpursNum));
-      for (ViInt32 idx{}; idx < retSpursNum; ++idx) {
-        CSpurData spur = *(reinterpret_cast<CSpurData *>(&buf[1]) + idx);
-        spursData.push_back(spur);
+    auto status = functor(ViInt32(fetchBufSize()), fetchBuf(), &retBufSize);
+    // A completely filled buffer may be truncated: grow it and fetch the
+    // latched results again instead of dropping the spurs that did not fit.
+    while ((status >= VI_SUCCESS) &&
+           (std::size_t(retBufSize) >= fetchBufSize())) {
+      try {
+        m_Buffer.resize(std::max(m_Buffer.size() * 2,
+                                 std::size_t(retBufSize) / spurParamsNum + 2));
+      } catch (...) {
+        return ViStatus{VI_ERROR_ALLOC};
       }
+      status = Invoke("AgXSAn_SASpuriousEmissionsTraceFetch",
+                      AgXSAn_SASpuriousEmissionsTraceFetch, m_Session,
+                      "Spurious_Results", ViInt32(fetchBufSize()), fetchBuf(),
+                      &retBufSize);
     }
+    if (status != VI_SUCCESS) return status;
+    const auto retSpursNum =
+        std::min(std::size_t(std::max(retBufSize, ViInt32{1}) - 1),
+                 fetchBufSize() - 1) /
+        spurParamsNum;
+    spursView = CSpursView{m_Buffer.data() + 1, retSpursNum};
     return status;
   }
 
  public:
+  // The view refers to a buffer owned by the session and stays valid until
+  // the next Read/Fetch call, so a steady-state loop does not allocate.
+  // Read/Fetch calls on one session must not overlap; while the session
+  // streams, they belong to the stream's I/O thread.
+  auto ReadSpuriousResults(Types::CSpursView &spursView,
+                           const std::chrono::milliseconds &timeout) const
+      noexcept {
+    return GetSpuriousResults(
+        spursView, [this, &timeout](ViInt32 size, ViReal64 *buf,
+                                    ViInt32 *retSize) {
+          return Invoke(
+              "AgXSAn_SASpuriousEmissionsTraceRead",
+              AgXSAn_SASpuriousEmissionsTraceRead, m_Session,
+              "Spurious_Results", ViInt32(timeout.count()), size, buf, retSize);
+        });
+  }
+  auto FetchSpuriousResults(Types::CSpursView &spursView) const noexcept {
+    return GetSpuriousResults(
+        spursView, [this](ViInt32 size, ViReal64 *buf, ViInt32 *retSize) {
+          return Invoke("AgXSAn_SASpuriousEmissionsTraceFetch",
+                        AgXSAn_SASpuriousEmissionsTraceFetch, m_Session,
+                        "Spurious_Results", size, buf, retSize);
+        });
+  }
   auto ReadSpuriousResults(Types::CSpursData &spursData,
                            const std::chrono::milliseconds &timeout) const
       noexcept {
-    using namespace std::placeholders;
-    const GetSpuriousResultsFunctorType traceRead = std::bind(
-        AgXSAn_SASpuriousEmissionsTraceRead, m_Session,
-        std::cref("Spurious_Results"), ViInt32(timeout.count()), _1, _2, _3);
-    return GetSpuriousResults(spursData, traceRead);
+    Types::CSpursView spursView{};
+    auto status = ReadSpuriousResults(spursView, timeout);
+    if (status != VI_SUCCESS) return status;
+    try {
+      spursData.insert(spursData.end(), spursView.begin(), spursView.end());
+    } catch (...) {
+      return ViStatus{VI_ERROR_ALLOC};
+    }
+    return status;
   }
   auto FetchSpuriousResults(Types::CSpursData &spursData) const noexcept {
-    using namespace std::placeholders;
-    const GetSpuriousResultsFunctorType traceFetch =
-        std::bind(AgXSAn_SASpuriousEmissionsTraceFetch, m_Session,
-                  std::cref("Spurious_Results"), _1, _2, _3);
-    return GetSpuriousResults(spursData, traceFetch);
+    Types::CSpursView spursView{};
+    auto status = FetchSpuriousResults(spursView);
+    if (status != VI_SUCCESS) return status;
+    try {
+      spursData.insert(spursData.end(), spursView.begin(), spursView.end());
+    } catch (...) {
+      return ViStatus{VI_ERROR_ALLOC};
+    }
+    return status;
+  }
+  // Column-wise overloads for the Spurs limit kernels, the records are
+  // transposed straight from the fetch buffer.
+  auto ReadSpuriousResults(Spurs::CSpursColumns &spursColumns,
+                           const std::chrono::milliseconds &timeout) const
+      noexcept {
+    Types::CSpursView spursView{};
+    auto status = ReadSpuriousResults(spursView, timeout);
+    if (status != VI_SUCCESS) return status;
+    try {
+      spursColumns.Append(spursView.data(), spursView.size());
+    } catch (...) {
+      return ViStatus{VI_ERROR_ALLOC};
+    }
+    return status;
+  }
+  auto FetchSpuriousResults(Spurs::CSpursColumns &spursColumns) const
+      noexcept {
+    Types::CSpursView spursView{};
+    auto status = FetchSpuriousResults(spursView);
+    if (status != VI_SUCCESS) return status;
+    try {
+      spursColumns.Append(spursView.data(), spursView.size());
+    } catch (...) {
+      return ViStatus{VI_ERROR_ALLOC};
+    }
+    return status;
+  }
+  // Fetches the results and reports to sink only what changed since the
+  // previous call with the same tracker.
+  template <typename Sink>
+  auto TrackSpuriousResults(Spurs::CSpurTracker &tracker, Sink &&sink) const
+      noexcept {
+    Types::CSpursView spursView{};
+    auto status = FetchSpuriousResults(spursView);
+    if (status != VI_SUCCESS) return status;
+    return tracker.Update(spursView.data(), spursView.size(), sink);
+  }
+  // Reads the results of every sweep on the stream's own I/O thread; meant
+  // for the continuous sweep mode.
+  auto StartStreaming(Types::CSpursStream &stream,
+                      const std::chrono::milliseconds &timeout) const
+      noexcept {
+    return stream.Start([this, timeout](Types::CSpursData &spursData) {
+      spursData.clear();
+      return ReadSpuriousResults(spursData, timeout);
+    });
   }
 };
 
@@ -278,10 +694,28 @@ class CAgXSAnSASpuriousEmissionsTraces : CIviInnerSessionReference {
 
  public:
   auto Abort() const noexcept {
-    return AgXSAn_SASpuriousEmissionsTracesAbort(m_Session);
+    return Invoke("AgXSAn_SASpuriousEmissionsTracesAbort",
+                  AgXSAn_SASpuriousEmissionsTracesAbort, m_Session);
   }
   auto Initiate() const noexcept {
-    return AgXSAn_SASpuriousEmissionsTracesInitiate(m_Session);
+    return Invoke("AgXSAn_SASpuriousEmissionsTracesInitiate",
+                  AgXSAn_SASpuriousEmissionsTracesInitiate, m_Session);
+  }
+  // Starts the measurement and returns at once; operation tracks completion
+  // and Cancel() aborts the measurement.
+  auto InitiateAsync(CAgXSAnOperation &operation,
+                     CompletionMode mode = CompletionMode::Polling) const
+      noexcept {
+    auto abort = [](CIviInnerSession &session) {
+      return session.Invoke("AgXSAn_SASpuriousEmissionsTracesAbort",
+                            AgXSAn_SASpuriousEmissionsTracesAbort,
+                            session.Handle);
+    };
+    operation = CAgXSAnOperation{m_InnerSession, abort, mode};
+    return operation.Start([this] {
+      return Invoke("AgXSAn_SASpuriousEmissionsTracesInitiate",
+                    AgXSAn_SASpuriousEmissionsTracesInitiate, m_Session);
+    });
   }
 };
 
@@ -299,8 +733,11 @@ class CAgXSAnSASpuriousEmissionsRangeTableStart : CIviInnerSessionReference {
   auto ConfigureFrequency(Types::CFrequencyTable<size> &table) const noexcept {
     using namespace Types;
     staticAssertRangeTable<size>();
-    return AgXSAn_SASpuriousEmissionsRangeTableStartConfigureFrequency(
-        m_Session, size, table.data());
+    return Attribute::SetTable(
+        m_InnerSession,
+        "AgXSAn_SASpuriousEmissionsRangeTableStartConfigureFrequency",
+        AgXSAn_SASpuriousEmissionsRangeTableStartConfigureFrequency, size,
+        table.data());
   }
   template <typename... Args>
   std::enable_if_t<std::conjunction_v<std::is_same<Args, ViReal64>...>,
@@ -309,16 +746,22 @@ class CAgXSAnSASpuriousEmissionsRangeTableStart : CIviInnerSessionReference {
     using namespace Types;
     staticAssertArgsSize<sizeof...(args)>();
     CFrequencyTable<sizeof...(args)> tmp{{args...}};
-    return AgXSAn_SASpuriousEmissionsRangeTableStartConfigureFrequency(
-        m_Session, tmp.size(), tmp.data());
+    return Attribute::SetTable(
+        m_InnerSession,
+        "AgXSAn_SASpuriousEmissionsRangeTableStartConfigureFrequency",
+        AgXSAn_SASpuriousEmissionsRangeTableStartConfigureFrequency, tmp.size(),
+        tmp.data());
   }
   template <ViInt32 size>
   auto ConfigureAbsoluteAmplitudeLimit(
       Types::CAbsoluteAmplitudeLimitTable<size> &table) const noexcept {
     using namespace Types;
     staticAssertRangeTable<size>();
-    return AgXSAn_SASpuriousEmissionsRangeTableStartConfigureAbsoluteAmplitudeLimit(
-        m_Session, size, table.data());
+    return Attribute::SetTable(
+        m_InnerSession,
+        "AgXSAn_SASpuriousEmissionsRangeTableStartConfigureAbsoluteAmplitudeLimit",
+        AgXSAn_SASpuriousEmissionsRangeTableStartConfigureAbsoluteAmplitudeLimit,
+        size, table.data());
   }
   template <typename... Args>
   std::enable_if_t<std::conjunction_v<std::is_same<Args, ViReal64>...>,
@@ -327,8 +770,11 @@ class CAgXSAnSASpuriousEmissionsRangeTableStart : CIviInnerSessionReference {
     using namespace Types;
     staticAssertArgsSize<sizeof...(args)>();
     CAbsoluteAmplitudeLimitTable<sizeof...(args)> tmp{{args...}};
-    return AgXSAn_SASpuriousEmissionsRangeTableStartConfigureAbsoluteAmplitudeLimit(
-        m_Session, tmp.size(), tmp.data());
+    return Attribute::SetTable(
+        m_InnerSession,
+        "AgXSAn_SASpuriousEmissionsRangeTableStartConfigureAbsoluteAmplitudeLimit",
+        AgXSAn_SASpuriousEmissionsRangeTableStartConfigureAbsoluteAmplitudeLimit,
+        tmp.size(), tmp.data());
   }
 };
 
@@ -344,8 +790,11 @@ class CAgXSAnSASpuriousEmissionsRangeTableStop : CIviInnerSessionReference {
   auto ConfigureFrequency(Types::CFrequencyTable<size> &table) const noexcept {
     using namespace Types;
     staticAssertRangeTable<size>();
-    return AgXSAn_SASpuriousEmissionsRangeTableStopConfigureFrequency(
-        m_Session, size, table.data());
+    return Attribute::SetTable(
+        m_InnerSession,
+        "AgXSAn_SASpuriousEmissionsRangeTableStopConfigureFrequency",
+        AgXSAn_SASpuriousEmissionsRangeTableStopConfigureFrequency, size,
+        table.data());
   }
   template <typename... Args>
   std::enable_if_t<std::conjunction_v<std::is_same<Args, ViReal64>...>,
@@ -354,16 +803,22 @@ class CAgXSAnSASpuriousEmissionsRangeTableStop : CIviInnerSessionReference {
     using namespace Types;
     staticAssertArgsSize<sizeof...(args)>();
     CFrequencyTable<sizeof...(args)> tmp{{args...}};
-    return AgXSAn_SASpuriousEmissionsRangeTableStopConfigureFrequency(
-        m_Session, tmp.size(), tmp.data());
+    return Attribute::SetTable(
+        m_InnerSession,
+        "AgXSAn_SASpuriousEmissionsRangeTableStopConfigureFrequency",
+        AgXSAn_SASpuriousEmissionsRangeTableStopConfigureFrequency, tmp.size(),
+        tmp.data());
   }
   template <ViInt32 size>
   auto ConfigureAbsoluteAmplitudeLimit(
       Types::CAbsoluteAmplitudeLimitTable<size> &table) const noexcept {
     using namespace Types;
     staticAssertRangeTable<size>();
-    return AgXSAn_SASpuriousEmissionsRangeTableStopConfigureAbsoluteAmplitudeLimit(
-        m_Session, size, table.data());
+    return Attribute::SetTable(
+        m_InnerSession,
+        "AgXSAn_SASpuriousEmissionsRangeTableStopConfigureAbsoluteAmplitudeLimit",
+        AgXSAn_SASpuriousEmissionsRangeTableStopConfigureAbsoluteAmplitudeLimit,
+        size, table.data());
   }
   template <typename... Args>
   std::enable_if_t<std::conjunction_v<std::is_same<Args, ViReal64>...>,
@@ -372,8 +827,11 @@ class CAgXSAnSASpuriousEmissionsRangeTableStop : CIviInnerSessionReference {
     using namespace Types;
     staticAssertArgsSize<sizeof...(args)>();
     CAbsoluteAmplitudeLimitTable<sizeof...(args)> tmp{{args...}};
-    return AgXSAn_SASpuriousEmissionsRangeTableStopConfigureAbsoluteAmplitudeLimit(
-        m_Session, tmp.size(), tmp.data());
+    return Attribute::SetTable(
+        m_InnerSession,
+        "AgXSAn_SASpuriousEmissionsRangeTableStopConfigureAbsoluteAmplitudeLimit",
+        AgXSAn_SASpuriousEmissionsRangeTableStopConfigureAbsoluteAmplitudeLimit,
+        tmp.size(), tmp.data());
   }
   template <ViInt32 size>
   auto ConfigureAbsoluteAmplitudeLimitAutoEnabled(
@@ -381,8 +839,11 @@ class CAgXSAnSASpuriousEmissionsRangeTableStop : CIviInnerSessionReference {
       noexcept {
     using namespace Types;
     staticAssertRangeTable<size>();
-    return AgXSAn_SASpuriousEmissionsRangeTableStopConfigureAbsoluteAmplitudeLimitAutoEnabled(
-        m_Session, size, table.data());
+    return Attribute::SetTable(
+        m_InnerSession,
+        "AgXSAn_SASpuriousEmissionsRangeTableStopConfigureAbsoluteAmplitudeLimitAutoEnabled",
+        AgXSAn_SASpuriousEmissionsRangeTableStopConfigureAbsoluteAmplitudeLimitAutoEnabled,
+        size, table.data());
   }
   template <typename... Args>
   std::enable_if_t<std::conjunction_v<std::is_same<Args, ViBoolean>...>,
@@ -391,8 +852,11 @@ class CAgXSAnSASpuriousEmissionsRangeTableStop : CIviInnerSessionReference {
     using namespace Types;
     staticAssertArgsSize<sizeof...(args)>();
     CAbsoluteAmplitudeLimitAutoEnabledTable<sizeof...(args)> tmp{{args...}};
-    return AgXSAn_SASpuriousEmissionsRangeTableStopConfigureAbsoluteAmplitudeLimitAutoEnabled(
-        m_Session, tmp.size(), tmp.data());
+    return Attribute::SetTable(
+        m_InnerSession,
+        "AgXSAn_SASpuriousEmissionsRangeTableStopConfigureAbsoluteAmplitudeLimitAutoEnabled",
+        AgXSAn_SASpuriousEmissionsRangeTableStopConfigureAbsoluteAmplitudeLimitAutoEnabled,
+        tmp.size(), tmp.data());
   }
 };
 
@@ -410,8 +874,11 @@ class CAgXSAnSASpuriousEmissionsRangeTableBandwidth
       noexcept {
     using namespace Types;
     staticAssertRangeTable<size>();
-    return AgXSAn_SASpuriousEmissionsRangeTableBandwidthConfigureResolution(
-        m_Session, size, table.data());
+    return Attribute::SetTable(
+        m_InnerSession,
+        "AgXSAn_SASpuriousEmissionsRangeTableBandwidthConfigureResolution",
+        AgXSAn_SASpuriousEmissionsRangeTableBandwidthConfigureResolution, size,
+        table.data());
   }
   template <typename... Args>
   std::enable_if_t<std::conjunction_v<std::is_same<Args, ViReal64>...>,
@@ -420,8 +887,11 @@ class CAgXSAnSASpuriousEmissionsRangeTableBandwidth
     using namespace Types;
     staticAssertArgsSize<sizeof...(args)>();
     CResolutionTable<sizeof...(args)> tmp{{args...}};
-    return AgXSAn_SASpuriousEmissionsRangeTableBandwidthConfigureResolution(
-        m_Session, tmp.size(), tmp.data());
+    return Attribute::SetTable(
+        m_InnerSession,
+        "AgXSAn_SASpuriousEmissionsRangeTableBandwidthConfigureResolution",
+        AgXSAn_SASpuriousEmissionsRangeTableBandwidthConfigureResolution,
+        tmp.size(), tmp.data());
   }
 };
 
@@ -429,14 +899,73 @@ class CAgXSAnSASpuriousEmissionsRangeTableBandwidth
 
 class CAgXSAnSASpuriousEmissionsRangeTable : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
+  mutable std::string m_Response{};
+  // Fills column from a comma separated list, extra values are ignored.
+  template <typename Column>
+  static ViStatus ParseColumn(const ViChar *data, std::size_t dataSize,
+                              Column &column) noexcept {
+    std::size_t idx{};
+    Scpi::CScpiRealListParser parser{};
+    auto sink = [&column, &idx](ViReal64 value) {
+      using ElementType = typename Column::value_type;
+      if (idx < column.size()) {
+        if constexpr (std::is_same_v<ElementType, ViBoolean>) {
+          column[idx] = (value != 0) ? VI_TRUE : VI_FALSE;
+        } else {
+          column[idx] = ElementType(value);
+        }
+      }
+      ++idx;
+      return ViStatus{VI_SUCCESS};
+    };
+    auto status = parser.Consume(data, dataSize, sink);
+    if (status == VI_SUCCESS) status = parser.Finish(sink);
+    if ((status == VI_SUCCESS) && (idx < column.size())) {
+      status = VI_ERROR_INV_RESPONSE;
+    }
+    return status;
+  }
+  template <typename... Columns>
+  ViStatus QueryColumns(ViConstString query, Columns &... columns) const
+      noexcept {
+    auto status = CAgXSAnIo::Write(m_InnerSession, query);
+    if (status != VI_SUCCESS) return status;
+    status = Scpi::ReadResponse(
+        [this](ViChar *buf, ViInt64 bufSize, ViInt64 *retSize) {
+          return CAgXSAnIo::Read(m_InnerSession, buf, bufSize, retSize);
+        },
+        m_Response);
+    if (status != VI_SUCCESS) return status;
+    std::size_t columnsNum{};
+    status = Scpi::SplitResponse(
+        m_Response.data(), m_Response.size(),
+        [&](std::size_t index, const ViChar *data, std::size_t dataSize) {
+          ++columnsNum;
+          std::size_t columnIdx{};
+          ViStatus columnStatus{VI_ERROR_INV_RESPONSE};
+          auto parse = [&](auto &column) {
+            if (columnIdx++ == index) {
+              columnStatus = ParseColumn(data, dataSize, column);
+            }
+          };
+          (parse(columns), ...);
+          return columnStatus;
+        });
+    if ((status == VI_SUCCESS) && (columnsNum != sizeof...(columns))) {
+      status = VI_ERROR_INV_RESPONSE;
+    }
+    return status;
+  }
 
  public:
   template <ViInt32 size>
   auto ConfigureEnabled(Types::CEnabledTable<size> &table) const noexcept {
     using namespace Types;
     staticAssertRangeTable<size>();
-    return AgXSAn_SASpuriousEmissionsRangeTableConfigureEnabled(m_Session, size,
-                                                                table.data());
+    return Attribute::SetTable(
+        m_InnerSession, "AgXSAn_SASpuriousEmissionsRangeTableConfigureEnabled",
+        AgXSAn_SASpuriousEmissionsRangeTableConfigureEnabled, size,
+        table.data());
   }
   template <typename... Args>
   std::enable_if_t<std::conjunction_v<std::is_same<Args, ViBoolean>...>,
@@ -445,16 +974,21 @@ class CAgXSAnSASpuriousEmissionsRangeTable : CIviInnerSessionReference {
     using namespace Types;
     staticAssertArgsSize<sizeof...(args)>();
     CEnabledTable<sizeof...(args)> tmp{{args...}};
-    return AgXSAn_SASpuriousEmissionsRangeTableConfigureEnabled(
-        m_Session, tmp.size(), tmp.data());
+    return Attribute::SetTable(
+        m_InnerSession, "AgXSAn_SASpuriousEmissionsRangeTableConfigureEnabled",
+        AgXSAn_SASpuriousEmissionsRangeTableConfigureEnabled, tmp.size(),
+        tmp.data());
   }
   template <ViInt32 size>
   auto ConfigureAttenuation(Types::CAttenuationTable<size> &table) const
       noexcept {
     using namespace Types;
     staticAssertRangeTable<size>();
-    return AgXSAn_SASpuriousEmissionsRangeTableConfigureAttenuation(
-        m_Session, size, table.data());
+    return Attribute::SetTable(
+        m_InnerSession,
+        "AgXSAn_SASpuriousEmissionsRangeTableConfigureAttenuation",
+        AgXSAn_SASpuriousEmissionsRangeTableConfigureAttenuation, size,
+        table.data());
   }
   template <typename... Args>
   std::enable_if_t<std::conjunction_v<std::is_same<Args, ViReal64>...>,
@@ -463,16 +997,22 @@ class CAgXSAnSASpuriousEmissionsRangeTable : CIviInnerSessionReference {
     using namespace Types;
     staticAssertArgsSize<sizeof...(args)>();
     CAttenuationTable<sizeof...(args)> tmp{{args...}};
-    return AgXSAn_SASpuriousEmissionsRangeTableConfigureAttenuation(
-        m_Session, tmp.size(), tmp.data());
+    return Attribute::SetTable(
+        m_InnerSession,
+        "AgXSAn_SASpuriousEmissionsRangeTableConfigureAttenuation",
+        AgXSAn_SASpuriousEmissionsRangeTableConfigureAttenuation, tmp.size(),
+        tmp.data());
   }
   template <ViInt32 size>
   auto ConfigureSweepPointsAutoEnabled(
       Types::CSweepPointsAutoEnabledTable<size> &table) const noexcept {
     using namespace Types;
     staticAssertRangeTable<size>();
-    return AgXSAn_SASpuriousEmissionsRangeTableConfigureSweepPointsAutoEnabled(
-        m_Session, size, table.data());
+    return Attribute::SetTable(
+        m_InnerSession,
+        "AgXSAn_SASpuriousEmissionsRangeTableConfigureSweepPointsAutoEnabled",
+        AgXSAn_SASpuriousEmissionsRangeTableConfigureSweepPointsAutoEnabled,
+        size, table.data());
   }
   template <typename... Args>
   std::enable_if_t<std::conjunction_v<std::is_same<Args, ViBoolean>...>,
@@ -481,16 +1021,20 @@ class CAgXSAnSASpuriousEmissionsRangeTable : CIviInnerSessionReference {
     using namespace Types;
     staticAssertArgsSize<sizeof...(args)>();
     CSweepPointsAutoEnabledTable<sizeof...(args)> tmp{{args...}};
-    return AgXSAn_SASpuriousEmissionsRangeTableConfigureSweepPointsAutoEnabled(
-        m_Session, tmp.size(), tmp.data());
+    return Attribute::SetTable(
+        m_InnerSession,
+        "AgXSAn_SASpuriousEmissionsRangeTableConfigureSweepPointsAutoEnabled",
+        AgXSAn_SASpuriousEmissionsRangeTableConfigureSweepPointsAutoEnabled,
+        tmp.size(), tmp.data());
   }
   template <ViInt32 size>
   auto QuerySweepTime(Types::CSweepTimeTable<size> &table) const noexcept {
     using namespace Types;
     staticAssertRangeTable<size>();
     ViInt32 retBufSize{};
-    return AgXSAn_SASpuriousEmissionsRangeTableQuerySweepTime(
-        m_Session, size, table.data(), &retBufSize);
+    return Invoke("AgXSAn_SASpuriousEmissionsRangeTableQuerySweepTime",
+                  AgXSAn_SASpuriousEmissionsRangeTableQuerySweepTime, m_Session,
+                  size, table.data(), &retBufSize);
   }
   template <typename... Args>
   std::enable_if_t<std::conjunction_v<std::is_same<Args, ViReal64>...>,
@@ -500,16 +1044,61 @@ class CAgXSAnSASpuriousEmissionsRangeTable : CIviInnerSessionReference {
     staticAssertArgsSize<sizeof...(args)>();
     CSweepTimeTable<sizeof...(args)> tmp{{args...}};
     ViInt32 retBufSize{};
-    return AgXSAn_SASpuriousEmissionsRangeTableQuerySweepTime(
-        m_Session, tmp.size(), tmp.data(), &retBufSize);
+    auto status = Invoke("AgXSAn_SASpuriousEmissionsRangeTableQuerySweepTime",
+                         AgXSAn_SASpuriousEmissionsRangeTableQuerySweepTime,
+                         m_Session, tmp.size(), tmp.data(), &retBufSize);
+    if (status == VI_SUCCESS) {
+      std::size_t idx{};
+      ((args = tmp[idx++]), ...);
+    }
+    return status;
+  }
+  // Reads every column with one compound query instead of a driver call per
+  // column. Only the first size rows are kept.
+  template <ViInt32 size>
+  auto QueryState(Types::CRangeTableState<size> &state) const noexcept {
+    using namespace Types;
+    staticAssertRangeTable<size>();
+    return QueryColumns(
+        ":SENS:SPUR:STAT?;:SENS:SPUR:FREQ:STAR?;:SENS:SPUR:FREQ:STOP?;"
+        ":SENS:SPUR:LIM:ABS:DATA:STAR?;:SENS:SPUR:LIM:ABS:DATA:STOP?;"
+        ":SENS:SPUR:LIM:ABS:DATA:STOP:AUTO?;:SENS:SPUR:BAND:RES?;"
+        ":SENS:SPUR:ATT?;:SENS:SPUR:PEAK:THR?;:SENS:SPUR:SWE:POIN?;"
+        ":SENS:SPUR:SWE:POIN:AUTO?;:SENS:SPUR:SWE:TIME?",
+        state.Enabled, state.StartFrequency, state.StopFrequency,
+        state.StartAbsoluteAmplitudeLimit, state.StopAbsoluteAmplitudeLimit,
+        state.StopAbsoluteAmplitudeLimitAutoEnabled, state.Resolution,
+        state.Attenuation, state.PeakThreshold, state.SweepPoints,
+        state.SweepPointsAutoEnabled, state.SweepTime);
+  }
+  // Sum of the sweep times of the enabled ranges, i.e. what the instrument
+  // expects a whole spurious measurement to take.
+  auto QueryTotalSweepTime(std::chrono::nanoseconds &sweepTime) const
+      noexcept {
+    using namespace Types;
+    CAgXSAnEnabledTable enabled{};
+    CAgXSAnSweepTimeTable sweepTimes{};
+    auto status = QueryColumns(":SENS:SPUR:STAT?;:SENS:SPUR:SWE:TIME?",
+                               enabled, sweepTimes);
+    if (status != VI_SUCCESS) return status;
+    ViReal64 total{};
+    for (std::size_t idx{}; idx < enabled.size(); ++idx) {
+      if (enabled[idx] == VI_TRUE) total += sweepTimes[idx];
+    }
+    sweepTime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::duration<ViReal64>(total));
+    return status;
   }
   template <ViInt32 size>
   auto ConfigurePeakThreshold(Types::CPeakThresholdTable<size> &table) const
       noexcept {
     using namespace Types;
     staticAssertRangeTable<size>();
-    return AgXSAn_SASpuriousEmissionsRangeTableConfigurePeakThreshold(
-        m_Session, size, table.data());
+    return Attribute::SetTable(
+        m_InnerSession,
+        "AgXSAn_SASpuriousEmissionsRangeTableConfigurePeakThreshold",
+        AgXSAn_SASpuriousEmissionsRangeTableConfigurePeakThreshold, size,
+        table.data());
   }
   template <typename... Args>
   std::enable_if_t<std::conjunction_v<std::is_same<Args, ViReal64>...>,
@@ -518,14 +1107,17 @@ class CAgXSAnSASpuriousEmissionsRangeTable : CIviInnerSessionReference {
     using namespace Types;
     staticAssertArgsSize<sizeof...(args)>();
     CPeakThresholdTable<sizeof...(args)> tmp{{args...}};
-    return AgXSAn_SASpuriousEmissionsRangeTableConfigurePeakThreshold(
-        m_Session, tmp.size(), tmp.data());
+    return Attribute::SetTable(
+        m_InnerSession,
+        "AgXSAn_SASpuriousEmissionsRangeTableConfigurePeakThreshold",
+        AgXSAn_SASpuriousEmissionsRangeTableConfigurePeakThreshold, tmp.size(),
+        tmp.data());
   }
 
   Bandwidth::CAgXSAnSASpuriousEmissionsRangeTableBandwidth const Badwidth{
-      m_Session};
-  Start::CAgXSAnSASpuriousEmissionsRangeTableStart const Start{m_Session};
-  Stop::CAgXSAnSASpuriousEmissionsRangeTableStop const Stop{m_Session};
+      m_InnerSession};
+  Start::CAgXSAnSASpuriousEmissionsRangeTableStart const Start{m_InnerSession};
+  Stop::CAgXSAnSASpuriousEmissionsRangeTableStop const Stop{m_InnerSession};
 };
 
 }  // namespace RangeTable
@@ -534,19 +1126,28 @@ namespace Display {
 
 namespace Window {
 
+struct CReferenceAttribute
+    : CIviAttribute<AGXSAN_ATTR_SA_SPURIOUSEMISSIONS_DISPLAY_WINDOWY_REFERENCE,
+                    ViReal64> {
+  static constexpr std::string_view Command{
+      ":DISP:SPUR:VIEW:WIND:TRAC:Y:RLEV"};
+};
+struct CScaleAttribute
+    : CIviAttribute<AGXSAN_ATTR_SA_SPURIOUSEMISSIONS_DISPLAY_WINDOWY_SCALE,
+                    ViReal64> {
+  static constexpr std::string_view Command{
+      ":DISP:SPUR:VIEW:WIND:TRAC:Y:PDIV"};
+};
+
 class CAgXSAnSASpuriousEmissionsDisplayWindow : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
 
  public:
   auto ConfigureReference(ViReal64 value) const noexcept {
-    return AgXSAn_SetAttributeViReal64(
-        m_Session, nullptr,
-        AGXSAN_ATTR_SA_SPURIOUSEMISSIONS_DISPLAY_WINDOWY_REFERENCE, value);
+    return Attribute::Set<CReferenceAttribute>(m_InnerSession, value);
   }
   auto ConfigureScale(ViReal64 value) const noexcept {
-    return AgXSAn_SetAttributeViReal64(
-        m_Session, nullptr,
-        AGXSAN_ATTR_SA_SPURIOUSEMISSIONS_DISPLAY_WINDOWY_SCALE, value);
+    return Attribute::Set<CScaleAttribute>(m_InnerSession, value);
   }
 };
 
@@ -556,27 +1157,95 @@ class CAgXSAnSASpuriousEmissionsDisplay : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
 
  public:
-  Window::CAgXSAnSASpuriousEmissionsDisplayWindow const Window{m_Session};
+  Window::CAgXSAnSASpuriousEmissionsDisplayWindow const Window{m_InnerSession};
 };
 
 }  // namespace Display
 
+using CFastMeasurementAttribute =
+    CIviAttribute<AGXSAN_ATTR_SA_SPURIOUSEMISSIONS_FAST_MEASUREMENT_ENABLED,
+                  bool, ViBoolean>;
+
 class CAgXSAnSASpuriousEmissions : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
 
  public:
   auto Configure() const noexcept {
-    return AgXSAn_SASpuriousEmissionsConfigure(m_Session);
+    m_InnerSession.Invalidate();
+    return Invoke("AgXSAn_SASpuriousEmissionsConfigure",
+                  AgXSAn_SASpuriousEmissionsConfigure, m_Session);
   }
   auto FastMeasurementEnabled(bool enabled = true) const noexcept {
-    return AgXSAn_SetAttributeViBoolean(
-        m_Session, nullptr,
-        AGXSAN_ATTR_SA_SPURIOUSEMISSIONS_FAST_MEASUREMENT_ENABLED, enabled);
+    return Attribute::Set<CFastMeasurementAttribute>(m_InnerSession, enabled);
   }
-  Traces::CAgXSAnSASpuriousEmissionsTraces const Traces{m_Session};
-  Trace::CAgXSAnSASpuriousEmissionsTrace const Trace{m_Session};
-  RangeTable::CAgXSAnSASpuriousEmissionsRangeTable const RangeTable{m_Session};
-  Display::CAgXSAnSASpuriousEmissionsDisplay const Display{m_Session};
+  // Initiates the measurement, sleeps for the time the scheduler predicts
+  // from the enabled ranges' sweep times, then checks for completion with a
+  // single *ESR? and only if the sweep is still running blocks for the rest
+  // of it. Fetches the results into spurs (anything FetchSpuriousResults
+  // takes) and feeds the observed completion time back into the scheduler.
+  template <typename SpursType>
+  auto ReadSpuriousResults(CIviSweepScheduler &scheduler, SpursType &spurs,
+                           const std::chrono::milliseconds &timeout) const
+      noexcept {
+    using ClockType = CIviSweepScheduler::ClockType;
+    std::chrono::nanoseconds expected{};
+    auto status = RangeTable.QueryTotalSweepTime(expected);
+    if (status != VI_SUCCESS) return status;
+    CAgXSAnOperation operation{};
+    status = Traces.InitiateAsync(operation);
+    if (status != VI_SUCCESS) return status;
+    const auto start = ClockType::now();
+    const auto deadline = start + timeout;
+    std::this_thread::sleep_until(
+        std::min(start + scheduler.WakeUp(expected), deadline));
+    const auto wakeUp = ClockType::now();
+    bool isComplete{};
+    status = operation.Poll(isComplete);
+    if (status != VI_SUCCESS) return status;
+    const auto checked = ClockType::now();
+    auto end = wakeUp;
+    if (!isComplete) {
+      if (checked >= deadline) return VI_ERROR_TMO;
+      const auto remaining =
+          std::chrono::ceil<std::chrono::milliseconds>(deadline - checked);
+      status = Invoke("AgXSAn_SystemWaitForOperationComplete",
+                      AgXSAn_SystemWaitForOperationComplete, m_Session,
+                      ViInt32(remaining.count()));
+      if (status != VI_SUCCESS) return status;
+      // The *OPC? reply trails the completion by about one query round
+      // trip, the one the *ESR? check has just measured.
+      end = std::max(ClockType::now() - (checked - wakeUp), checked);
+    }
+    scheduler.Observe(expected, end - start, end - wakeUp, isComplete);
+    return Trace.FetchSpuriousResults(spurs);
+  }
+  // Measures sweepsNum times back to back: each sweep is initiated right
+  // after the previous results are fetched, and process runs on them while
+  // the next sweep is in progress. Process is
+  // ViStatus(const Types::CSpursData &, std::size_t sweepIdx).
+  template <typename Process>
+  auto ReadSpuriousResults(Types::CSpursPipeline &pipeline,
+                           std::size_t sweepsNum,
+                           const std::chrono::milliseconds &timeout,
+                           Process &&process) const noexcept {
+    return pipeline.Run(
+        sweepsNum, [this] { return Traces.Initiate(); },
+        [this, &timeout] {
+          return Invoke("AgXSAn_SystemWaitForOperationComplete",
+                        AgXSAn_SystemWaitForOperationComplete, m_Session,
+                        ViInt32(timeout.count()));
+        },
+        [this](Types::CSpursData &spursData) {
+          spursData.clear();
+          return Trace.FetchSpuriousResults(spursData);
+        },
+        std::forward<Process>(process));
+  }
+  Traces::CAgXSAnSASpuriousEmissionsTraces const Traces{m_InnerSession};
+  Trace::CAgXSAnSASpuriousEmissionsTrace const Trace{m_InnerSession};
+  RangeTable::CAgXSAnSASpuriousEmissionsRangeTable const RangeTable{
+      m_InnerSession};
+  Display::CAgXSAnSASpuriousEmissionsDisplay const Display{m_InnerSession};
 };
 
 }  // namespace SpuriousEmissions
@@ -588,10 +1257,29 @@ class CAgXSAnSASweptSAs : CIviInnerSessionReference {
 
  public:
   auto Configure() const noexcept {
-    return AgXSAn_SASweptSAsConfigure(m_Session);
+    m_InnerSession.Invalidate();
+    return Invoke("AgXSAn_SASweptSAsConfigure", AgXSAn_SASweptSAsConfigure,
+                  m_Session);
   }
   auto Initiate() const noexcept {
-    return AgXSAn_SASweptSAsInitiate(m_Session);
+    return Invoke("AgXSAn_SASweptSAsInitiate", AgXSAn_SASweptSAsInitiate,
+                  m_Session);
+  }
+  // Starts the sweep and returns at once; operation tracks completion and
+  // Cancel() aborts the sweep.
+  auto InitiateAsync(CAgXSAnOperation &operation,
+                     CompletionMode mode = CompletionMode::Polling) const
+      noexcept {
+    auto abort = [](CIviInnerSession &session) {
+      return session.Invoke("AgXSAn_SystemWriteString",
+                            AgXSAn_SystemWriteString, session.Handle, ":ABOR");
+    };
+    operation = CAgXSAnOperation{m_InnerSession, abort, mode};
+    return operation.Start(
+        [this] {
+          return Invoke("AgXSAn_SASweptSAsInitiate", AgXSAn_SASweptSAsInitiate,
+                        m_Session);
+        });
   }
 };
 
@@ -604,10 +1292,12 @@ class CAgXSAnSAMarkers : CIviInnerSessionReference {
 
  public:
   auto SearchHighest() const noexcept {
-    return AgXSAn_SAMarkerSearch(m_Session, AGXSAN_VAL_MARKER_SEARCH_HIGHEST);
+    return Invoke("AgXSAn_SAMarkerSearch", AgXSAn_SAMarkerSearch, m_Session,
+                  AGXSAN_VAL_MARKER_SEARCH_HIGHEST);
   }
   auto Query(double &position, double &amplitude) const noexcept {
-    return AgXSAn_SAMarkerQuery(m_Session, &position, &amplitude);
+    return Invoke("AgXSAn_SAMarkerQuery", AgXSAn_SAMarkerQuery, m_Session,
+                  &position, &amplitude);
   }
 };
 
@@ -618,9 +1308,9 @@ class CAgXSAnSA : CIviInnerSessionReference {
 
  public:
   SpuriousEmissions::CAgXSAnSASpuriousEmissions const SpuriousEmissions{
-      m_Session};
-  SweptSAs::CAgXSAnSASweptSAs const SweptSAs{m_Session};
-  Markers::CAgXSAnSAMarkers const Markers{m_Session};
+      m_InnerSession};
+  SweptSAs::CAgXSAnSASweptSAs const SweptSAs{m_InnerSession};
+  Markers::CAgXSAnSAMarkers const Markers{m_InnerSession};
 };
 
 }  // namespace SA
@@ -631,11 +1321,72 @@ class CAgXSAnSystem : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
 
  public:
-  auto ClearIO() const noexcept { return AgXSAn_SystemClearIO(m_Session); }
+  auto ClearIO() const noexcept {
+    return Invoke("AgXSAn_SystemClearIO", AgXSAn_SystemClearIO, m_Session);
+  }
   auto WaitForOperationComplete(const std::chrono::milliseconds &timeout) const
       noexcept {
-    return AgXSAn_SystemWaitForOperationComplete(m_Session,
-                                                 ViInt32(timeout.count()));
+    return Invoke("AgXSAn_SystemWaitForOperationComplete",
+                  AgXSAn_SystemWaitForOperationComplete, m_Session,
+                  ViInt32(timeout.count()));
+  }
+  // ServiceRequest waits for SRQ instead of blocking inside the driver, so
+  // it returns within milliseconds of completion.
+  auto WaitForOperationComplete(const std::chrono::milliseconds &timeout,
+                                CompletionMode mode) const noexcept {
+    if (mode == CompletionMode::Polling) {
+      return WaitForOperationComplete(timeout);
+    }
+    CAgXSAnOperation operation{m_InnerSession, nullptr, mode};
+    auto status = operation.Start([] { return ViStatus{VI_SUCCESS}; });
+    if (status != VI_SUCCESS) return status;
+    return operation.Wait(timeout);
+  }
+  // Runs sequence (ViStatus()) with the Configure* calls recorded into
+  // batch instead of being sent, e.g.
+  //   System.Record(batch, [&] { return Display.ConfigureMaximize(); });
+  // Settings without a SCPI header fail with VI_ERROR_NSUP_OPER.
+  template <typename Sequence>
+  auto Record(Scpi::CScpiBatch &batch, Sequence &&sequence) const noexcept {
+    return CAgXSAnState::Record(m_InnerSession, batch,
+                                std::forward<Sequence>(sequence));
+  }
+  // Sends the whole batch as one program message and waits for it with a
+  // single *OPC? and SYST:ERR? check. errorCode is the first queued
+  // instrument error (0 if none); the rest of the queue is drained.
+  auto Execute(const Scpi::CScpiBatch &batch, ViInt32 &errorCode) const
+      noexcept {
+    return CAgXSAnState::Execute(m_InnerSession, batch, errorCode);
+  }
+  // As above, with every queued instrument error.
+  auto Execute(const Scpi::CScpiBatch &batch,
+               std::vector<CIviDeferredError> &errors) const noexcept {
+    return CAgXSAnState::Execute(m_InnerSession, batch, errors);
+  }
+  // Reads every setting the wrapper manages back from the instrument.
+  auto CaptureState(CIviStateSnapshot &snapshot) const noexcept {
+    return CAgXSAnState::Capture(m_InnerSession, snapshot);
+  }
+  // Captures the state and stores it in instrument state register number
+  // too (*SAV), so it can be recalled with a single command.
+  auto SaveState(CIviStateSnapshot &snapshot, ViInt32 number,
+                 ViInt32 &errorCode) const noexcept {
+    return CAgXSAnState::Save(m_InnerSession, snapshot, number, errorCode);
+  }
+  // A snapshot bound to a state register is recalled with one *RCL,
+  // otherwise only the settings differing from the cache are sent.
+  auto RecallState(const CIviStateSnapshot &snapshot, ViInt32 &errorCode) const
+      noexcept {
+    return CAgXSAnState::Recall(m_InnerSession, snapshot, errorCode);
+  }
+  // Runs sequence (ViStatus()) with the driver's per-call instrument status
+  // query turned off, then drains the error queue once. Each queued error
+  // is mapped to the driver call that most likely caused it.
+  template <typename Sequence>
+  auto ExecuteDeferred(Sequence &&sequence,
+                       std::vector<CIviDeferredError> &errors) const noexcept {
+    return CAgXSAnDeferredExecution::Execute(
+        m_InnerSession, std::forward<Sequence>(sequence), errors);
   }
 };
 
@@ -647,12 +1398,18 @@ class CAgXSAnUtility : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
 
  public:
-  auto Reset() const noexcept { return AgXSAn_reset(m_Session); }
-  auto ClearError() const noexcept { return AgXSAn_ClearError(m_Session); }
+  auto Reset() const noexcept {
+    m_InnerSession.Revert();
+    return Invoke("AgXSAn_reset", AgXSAn_reset, m_Session);
+  }
+  auto ClearError() const noexcept {
+    return Invoke("AgXSAn_ClearError", AgXSAn_ClearError, m_Session);
+  }
   template <ViInt32 size>
   auto GerError(ViStatus &code, std::array<ViChar, size> &description) const
       noexcept {
-    return AgXSAn_GetError(m_Session, &code, size, description.data());
+    return Invoke("AgXSAn_GetError", AgXSAn_GetError, m_Session, &code, size,
+                  description.data());
   }
 };
 
@@ -664,15 +1421,19 @@ namespace Rf {
 
 namespace Corrections {
 
+struct CFloorExtentionAttribute
+    : CIviAttribute<
+          AGXSAN_ATTR_INPUT_RF_CORRECTIONS_NOISE_FLOOR_EXTENSTION_ENABLED,
+          bool, ViBoolean> {
+  static constexpr std::string_view Command{":CORR:NOIS:FLO"};
+};
+
 class CAgXSAnInputRfCorrections : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
 
  public:
   auto ConfigureFloorExtentionEnabled(bool enabled = true) const noexcept {
-    return AgXSAn_SetAttributeViBoolean(
-        m_Session, nullptr,
-        AGXSAN_ATTR_INPUT_RF_CORRECTIONS_NOISE_FLOOR_EXTENSTION_ENABLED,
-        enabled);
+    return Attribute::Set<CFloorExtentionAttribute>(m_InnerSession, enabled);
   }
 };
 
@@ -682,7 +1443,7 @@ class CAgXSAnInputRf : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
 
  public:
-  Corrections::CAgXSAnInputRfCorrections const Corrections{m_Session};
+  Corrections::CAgXSAnInputRfCorrections const Corrections{m_InnerSession};
 };
 
 }  // namespace Rf
@@ -691,7 +1452,7 @@ class CAgXSAnInput : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
 
  public:
-  Rf::CAgXSAnInputRf const Rf{m_Session};
+  Rf::CAgXSAnInputRf const Rf{m_InnerSession};
 };
 
 }  // namespace Input
@@ -702,20 +1463,26 @@ class CAgXSAnFrequency : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
 
  public:
-  auto Tune() const noexcept { return AgXSAn_FrequencyTune(m_Session); }
+  auto Tune() const noexcept {
+    return Invoke("AgXSAn_FrequencyTune", AgXSAn_FrequencyTune, m_Session);
+  }
 };
 
 }  // namespace Frequency
 
 namespace Display {
 
+struct CFullScreenAttribute
+    : CIviAttribute<AGXSAN_ATTR_DISPLAY_FULL_SCREEN_ENABLED, bool, ViBoolean> {
+  static constexpr std::string_view Command{":DISP:FSCR"};
+};
+
 class CAgXSAnDisplay : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
 
  public:
   auto FullScreenEnabled(bool enabled = true) const noexcept {
-    return AgXSAn_SetAttributeViBoolean(
-        m_Session, nullptr, AGXSAN_ATTR_DISPLAY_FULL_SCREEN_ENABLED, enabled);
+    return Attribute::Set<CFullScreenAttribute>(m_InnerSession, enabled);
   }
 };
 
@@ -728,8 +1495,9 @@ class CAgXSAnBasicOperation : CIviInnerSessionReference {
 
  public:
   auto GetAttenuation(ViReal64 &value) const noexcept {
-    return AgXSAn_GetAttributeViReal64(m_Session, nullptr,
-                                       AGXSAN_ATTR_ATTENUATION, &value);
+    // Attenuation is auto-coupled, so it is never served from the cache.
+    return Invoke("AgXSAn_GetAttributeViReal64", AgXSAn_GetAttributeViReal64,
+                  m_Session, nullptr, AGXSAN_ATTR_ATTENUATION, &value);
   }
 };
 
@@ -737,83 +1505,192 @@ class CAgXSAnBasicOperation : CIviInnerSessionReference {
 
 namespace Acquisition {
 
+struct CContiniousSweepModeAttribute
+    : CIviAttribute<AGXSAN_ATTR_ACQUISITION_CONTINUOUS_SWEEP_MODE_ENABLED,
+                    bool, ViBoolean> {
+  static constexpr std::string_view Command{":INIT:CONT"};
+};
+
 class CAgXSAnAcquisition : CIviInnerSessionReference {
   using CIviInnerSessionReference::CIviInnerSessionReference;
 
  public:
   auto ContiniousSweepModeEnabled(bool enabled = true) const noexcept {
-    return AgXSAn_SetAttributeViBoolean(
-        m_Session, nullptr,
-        AGXSAN_ATTR_ACQUISITION_CONTINUOUS_SWEEP_MODE_ENABLED, enabled);
+    return Attribute::Set<CContiniousSweepModeAttribute>(m_InnerSession,
+                                                         enabled);
   }
 };
 
 }  // namespace Acquisition
 
-struct CAgXSAnOptions {
+inline ViStatus CAgXSAnIo::CaptureSettings(
+    CIviInnerSession &session,
+    CIviAttributeCache::CSnapshot &settings) noexcept {
+  namespace Spurious = SA::SpuriousEmissions;
+  auto status = CAgXSAnState::CaptureValues<
+      Spurious::Display::Window::CReferenceAttribute,
+      Spurious::Display::Window::CScaleAttribute,
+      Spurious::CFastMeasurementAttribute,
+      Input::Rf::Corrections::CFloorExtentionAttribute,
+      Display::CFullScreenAttribute,
+      Acquisition::CContiniousSweepModeAttribute>(session, settings);
+  if (status != VI_SUCCESS) return status;
+  // The range table is read with one compound query and kept as the tables
+  // its Configure* accessors upload, in an order where the auto flags come
+  // after the values they override.
+  Spurious::Types::CAgXSAnRangeTableState state{};
+  const Spurious::RangeTable::CAgXSAnSASpuriousEmissionsRangeTable rangeTable{
+      session};
+  status = rangeTable.QueryState(state);
+  auto capture = [&settings, &status](std::string_view function, auto &&call,
+                                      const auto &table) {
+    if (status != VI_SUCCESS) return;
+    status = Attribute::CaptureTable(settings, function, call, table.data(),
+                                     table.size());
+  };
+  capture("AgXSAn_SASpuriousEmissionsRangeTableConfigureEnabled",
+          AgXSAn_SASpuriousEmissionsRangeTableConfigureEnabled, state.Enabled);
+  capture("AgXSAn_SASpuriousEmissionsRangeTableStartConfigureFrequency",
+          AgXSAn_SASpuriousEmissionsRangeTableStartConfigureFrequency,
+          state.StartFrequency);
+  capture("AgXSAn_SASpuriousEmissionsRangeTableStopConfigureFrequency",
+          AgXSAn_SASpuriousEmissionsRangeTableStopConfigureFrequency,
+          state.StopFrequency);
+  capture(
+      "AgXSAn_SASpuriousEmissionsRangeTableStartConfigureAbsoluteAmplitudeLimit",
+      AgXSAn_SASpuriousEmissionsRangeTableStartConfigureAbsoluteAmplitudeLimit,
+      state.StartAbsoluteAmplitudeLimit);
+  capture(
+      "AgXSAn_SASpuriousEmissionsRangeTableStopConfigureAbsoluteAmplitudeLimit",
+      AgXSAn_SASpuriousEmissionsRangeTableStopConfigureAbsoluteAmplitudeLimit,
+      state.StopAbsoluteAmplitudeLimit);
+  capture(
+      "AgXSAn_SASpuriousEmissionsRangeTableStopConfigureAbsoluteAmplitudeLimitAutoEnabled",
+      AgXSAn_SASpuriousEmissionsRangeTableStopConfigureAbsoluteAmplitudeLimitAutoEnabled,
+      state.StopAbsoluteAmplitudeLimitAutoEnabled);
+  capture("AgXSAn_SASpuriousEmissionsRangeTableBandwidthConfigureResolution",
+          AgXSAn_SASpuriousEmissionsRangeTableBandwidthConfigureResolution,
+          state.Resolution);
+  capture("AgXSAn_SASpuriousEmissionsRangeTableConfigureAttenuation",
+          AgXSAn_SASpuriousEmissionsRangeTableConfigureAttenuation,
+          state.Attenuation);
+  capture("AgXSAn_SASpuriousEmissionsRangeTableConfigurePeakThreshold",
+          AgXSAn_SASpuriousEmissionsRangeTableConfigurePeakThreshold,
+          state.PeakThreshold);
+  capture(
+      "AgXSAn_SASpuriousEmissionsRangeTableConfigureSweepPointsAutoEnabled",
+      AgXSAn_SASpuriousEmissionsRangeTableConfigureSweepPointsAutoEnabled,
+      state.SweepPointsAutoEnabled);
+  return status;
+}
+
+struct CAgXSAnOptions : CIviDriverOptions {
   CAgXSAnOptions() = default;
   template <class COptions>
   CAgXSAnOptions(const COptions &opt)
-      : Model(static_cast<AgXSAnModel>(opt.Model)),
+      : CIviDriverOptions(IviOptions::DriverOptionsOf(opt)),
+        Model(static_cast<AgXSAnModel>(opt.Model)),
         Simulate(opt.Simulate),
         Reset(opt.Reset),
-        idQuery(opt.idQuery) {}
+        idQuery(opt.idQuery),
+        AttributeCache(IviOptions::AttributeCacheOf(opt)) {}
   AgXSAnModel Model{AgXSAnModel::Common};
   bool Simulate{};
   bool Reset{};
   bool idQuery{};
+  bool AttributeCache{};
+  bool operator==(const CAgXSAnOptions &other) const noexcept {
+    return (Model == other.Model) && (Simulate == other.Simulate) &&
+           (Reset == other.Reset) && (idQuery == other.idQuery) &&
+           (AttributeCache == other.AttributeCache) &&
+           CIviDriverOptions::operator==(other);
+  }
+  bool operator!=(const CAgXSAnOptions &other) const noexcept {
+    return !(*this == other);
+  }
 };
 
 class CAgXSAn {
-  ViSession m_Session{};
+  CIviInnerSession m_InnerSession{};
+  ViSession &m_Session{m_InnerSession.Handle};
   CAgXSAnOptions m_Options{};
+  static std::string_view ModelName(AgXSAnModel model) noexcept {
+    switch (model) {
+      case AgXSAnModel::N9030A:
+        return "N9030A";
+      default:
+        return {};
+    }
+  }
   std::string MakeOptionsString(const CAgXSAnOptions &options) {
-    using namespace std::string_literals;
-    auto opts = "Simulate="s;
     m_Options = options;
-    if (options.Simulate) {
-      opts += "true"s;
-    } else {
-      opts += "false"s;
-    }
-    if (options.Model != AgXSAnModel::Common) {
-      opts += ", DriverSetup=Model="s;
-      switch (options.Model) {
-        case AgXSAnModel::N9030A:
-          opts += "N9030A"s;
-          break;
-        default:
-          opts.clear();
-      }
-    }
-    return opts;
+    return IviOptions::MakeString(options, options.Simulate,
+                                  ModelName(options.Model));
   }
 
  public:
   auto Connect(const std::string &resource,
                const CAgXSAnOptions &options) noexcept {
     auto optionsString = MakeOptionsString(options);
-    return AgXSAn_InitWithOptions(ViRsrc(resource.data()), options.idQuery,
-                                  options.Reset, optionsString.data(),
-                                  &m_Session);
+    m_InnerSession.Revert();
+    m_InnerSession.AttributeCache.Enable(options.AttributeCache);
+    return m_InnerSession.Invoke(
+        "AgXSAn_InitWithOptions", AgXSAn_InitWithOptions,
+        ViRsrc(resource.data()), options.idQuery, options.Reset,
+        optionsString.data(), &m_Session);
   }
   void Close() noexcept {
-    AgXSAn_close(m_Session);
+    m_InnerSession.Invoke("AgXSAn_close", AgXSAn_close, m_Session);
     m_Session = 0;
+    m_InnerSession.Revert();
   }
   bool IsOpen() const noexcept { return (m_Session != 0); }
+  // Cheap liveness probe of an open session: a single status byte read,
+  // which leaves the instrument state and its queues untouched.
+  ViStatus CheckConnection() noexcept {
+    if (!IsOpen()) return VI_ERROR_CONN_LOST;
+    // A simulated session has no I/O session to lose.
+    if (m_Options.Simulate) return VI_SUCCESS;
+    ViUInt16 statusByte{};
+    return CAgXSAnIo::ReadStatusByte(m_InnerSession, statusByte);
+  }
   bool IsSimulate() const noexcept { return m_Options.Simulate; }
   ViSession GetSession() const noexcept { return m_Session; }
-  SA::CAgXSAnSA const SA{m_Session};
-  Input::CAgXSAnInput const Input{m_Session};
-  System::CAgXSAnSystem const System{m_Session};
-  Acquisition::CAgXSAnAcquisition const Acquisition{m_Session};
-  BasicOperation::CAgXSAnBasicOperation const BasicOperation{m_Session};
-  Display::CAgXSAnDisplay const Display{m_Session};
-  Utility::CAgXSAnUtility const Utility{m_Session};
-  Frequency::CAgXSAnFrequency const Frequency{m_Session};
+  const CIviAttributeCache::CStatistics &GetAttributeCacheStatistics() const
+      noexcept {
+    return m_InnerSession.AttributeCache.GetStatistics();
+  }
+  // Safe while other threads use the instrument. The profiler stays valid
+  // as long as the instrument; GetProfiler() is null while it is off.
+  void EnableProfiling(bool enabled = true) {
+    m_InnerSession.EnableProfiling(enabled);
+  }
+  const CIviCallProfiler *GetProfiler() const noexcept {
+    return m_InnerSession.Profiler.load(std::memory_order_acquire);
+  }
+  // Writes or reads a group of attributes given by their descriptors (the
+  // C*Attribute types next to the accessors) with a single status check.
+  template <typename... Descriptors>
+  auto SetAttributes(
+      const typename Descriptors::ValueType &... values) noexcept {
+    return Attribute::Set<Descriptors...>(m_InnerSession, values...);
+  }
+  template <typename... Descriptors>
+  auto GetAttributes(typename Descriptors::ValueType &... values) noexcept {
+    return Attribute::Get<Descriptors...>(m_InnerSession, values...);
+  }
+  SA::CAgXSAnSA const SA{m_InnerSession};
+  Input::CAgXSAnInput const Input{m_InnerSession};
+  System::CAgXSAnSystem const System{m_InnerSession};
+  Acquisition::CAgXSAnAcquisition const Acquisition{m_InnerSession};
+  BasicOperation::CAgXSAnBasicOperation const BasicOperation{m_InnerSession};
+  Display::CAgXSAnDisplay const Display{m_InnerSession};
+  Utility::CAgXSAnUtility const Utility{m_InnerSession};
+  Frequency::CAgXSAnFrequency const Frequency{m_InnerSession};
 };
 
+using CAgXSAnPool = CIviSessionPool<CAgXSAn, CAgXSAnOptions>;
+
 }  // namespace AgXSAn
 
 #endif  // AGXSAN_WRAPPER_H
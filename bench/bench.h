@@ -0,0 +1,109 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef IVI_BENCH_H
+#define IVI_BENCH_H
+
+// Minimal benchmark harness. Each benchmark runs in batches of doubling size
+// until a batch takes at least the minimum time, then prints one CSV line
+//   benchmark,parameter,items,iterations,ns_per_op
+// where items is the work per operation (e.g. spurs parsed), so results can
+// be compared between releases by script. A failing operation or setup step
+// is reported on stderr and makes main return Bench::Result() != 0.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "IviVisaType.h"
+
+namespace Bench {
+
+inline std::chrono::nanoseconds g_MinTime{std::chrono::milliseconds{200}};
+inline int g_Failures{};
+// Results stored here cannot be optimized away.
+inline volatile std::size_t g_Sink{};
+
+// Accepts --min-time-ms=<n>.
+inline void Init(int argc, char *argv[]) {
+  constexpr const char *minTimeOption{"--min-time-ms="};
+  for (int idx{1}; idx < argc; ++idx) {
+    if (std::strncmp(argv[idx], minTimeOption, std::strlen(minTimeOption)) ==
+        0) {
+      g_MinTime = std::chrono::milliseconds{
+          std::atoi(argv[idx] + std::strlen(minTimeOption))};
+    }
+  }
+  std::printf("benchmark,parameter,items,iterations,ns_per_op\n");
+}
+
+// Checks a setup step such as a connect; a failure counts like a failed
+// operation, and the benchmarks depending on the step are to be skipped.
+inline bool Setup(const char *name, ViStatus status) {
+  if (status >= VI_SUCCESS) return true;
+  ++g_Failures;
+  std::fprintf(stderr, "%s setup failed: %ld\n", name, long(status));
+  return false;
+}
+
+// Operation is ViStatus().
+template <typename Operation>
+void Run(const char *name, const std::string &parameter, std::size_t items,
+         Operation &&operation) {
+  using Clock = std::chrono::steady_clock;
+  std::size_t iterations{1};
+  for (;;) {
+    const auto start = Clock::now();
+    for (std::size_t idx{}; idx < iterations; ++idx) {
+      const ViStatus status{operation()};
+      if (status < VI_SUCCESS) {
+        ++g_Failures;
+        std::fprintf(stderr, "%s,%s failed: %ld\n", name, parameter.c_str(),
+                     long(status));
+        return;
+      }
+    }
+    const auto elapsed = Clock::now() - start;
+    if (elapsed >= g_MinTime) {
+      std::printf("%s,%s,%zu,%zu,%.1f\n", name, parameter.c_str(), items,
+                  iterations,
+                  double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             elapsed)
+                             .count()) /
+                      double(iterations));
+      return;
+    }
+    iterations *= 2;
+  }
+}
+
+inline int Result() { return (g_Failures == 0) ? 0 : 1; }
+
+}  // namespace Bench
+
+#endif  // IVI_BENCH_H
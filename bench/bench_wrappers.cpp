@@ -0,0 +1,256 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "agssa_wrapper.h"
+#include "agxsan_wrapper.h"
+#include "bench.h"
+#include "ivi_options.h"
+#include "stub_backend.h"
+
+// Wrapper overhead over the stub drivers, so the numbers show what the
+// wrappers add on top of the driver and not the instrument round trips.
+
+namespace {
+
+namespace Measurements = AgSsa::Application::PN::Measurements;
+
+constexpr std::array<std::size_t, 5> SpursNums{10, 100, 1000, 10000, 100000};
+// Longest spurious list the binary block transfer accepts.
+constexpr std::size_t BlockSpursMax{65536};
+
+constexpr std::uint32_t SpursSeed{2018};
+
+void BenchFacades() {
+  Stub::Reset();
+  Stub::Backend().IsWriteLogged = false;
+  AgSsa::CAgSsa ssa{};
+  if (!Bench::Setup("facades", ssa.Connect("TCPIP0::ssa::INSTR",
+                                           AgSsa::CAgSsaOptions{}))) {
+    return;
+  }
+  const auto session = ssa.GetSession();
+  Bench::Run("driver_set_attribute", "AgSsa", 1, [session] {
+    return AgSsa_SetAttributeViBoolean(session, "", AGSSA_ATTR_DISPLAY_MAXIMIZE,
+                                       VI_TRUE);
+  });
+  Bench::Run("facade_configure", "Display.ConfigureMaximize", 1,
+             [&ssa] { return ssa.Display.ConfigureMaximize(); });
+  int correlation{};
+  Bench::Run("facade_query", "PN.Aquisition.QueryCorrelation", 1,
+             [&ssa, &correlation] {
+               return ssa.Application.PN.Aquisition.QueryCorrelation(
+                   correlation);
+             });
+  ssa.Close();
+}
+
+void BenchSpuriousListParse() {
+  Stub::Reset();
+  Stub::Backend().IsWriteLogged = false;
+  Stub::Backend().ReadChunkMax = std::numeric_limits<std::size_t>::max();
+  AgSsa::CAgSsa ssa{};
+  if (!Bench::Setup("query_spurious_list",
+                    ssa.Connect("TCPIP0::ssa::INSTR",
+                                AgSsa::CAgSsaOptions{}))) {
+    return;
+  }
+  const auto &measurements = ssa.Application.PN.Measurements;
+  Measurements::CSpursData spursData{};
+  auto query = [&measurements, &spursData] {
+    spursData.clear();
+    return measurements.QuerySpuriousList(spursData);
+  };
+  for (const auto spursNum : SpursNums) {
+    if (!Bench::Setup("query_spurious_list_ascii",
+                      measurements.ConfigureDataFormat(
+                          Measurements::DataFormat::ASCii))) {
+      break;
+    }
+    const auto spurs = Stub::GenerateSpurs(spursNum, SpursSeed);
+    Stub::Backend().DefaultReply = Stub::MakeSpuriousList(spurs, false);
+    Bench::Run("query_spurious_list_ascii", std::to_string(spursNum),
+               spursNum, query);
+    if (spursNum > BlockSpursMax) continue;
+    if (!Bench::Setup("query_spurious_list_real64",
+                      measurements.ConfigureDataFormat(
+                          Measurements::DataFormat::Real64))) {
+      break;
+    }
+    Stub::Backend().DefaultReply = Stub::MakeSpuriousList(spurs, true);
+    Bench::Run("query_spurious_list_real64", std::to_string(spursNum),
+               spursNum, query);
+  }
+  ssa.Close();
+}
+
+// The same lists over a link moving a byte per 8 ns (gigabit LAN), where
+// the smaller binary reply pays off on top of the parsing.
+void BenchSpuriousListTransfer() {
+  constexpr std::size_t spursNum{10000};
+  Stub::Reset();
+  Stub::Backend().IsWriteLogged = false;
+  Stub::Backend().ReadChunkMax = std::numeric_limits<std::size_t>::max();
+  Stub::Backend().ByteCost = std::chrono::nanoseconds{8};
+  AgSsa::CAgSsa ssa{};
+  if (!Bench::Setup("transfer_spurious_list",
+                    ssa.Connect("TCPIP0::ssa::INSTR",
+                                AgSsa::CAgSsaOptions{}))) {
+    return;
+  }
+  const auto &measurements = ssa.Application.PN.Measurements;
+  const auto spurs = Stub::GenerateSpurs(spursNum, SpursSeed);
+  Measurements::CSpursData spursData{};
+  auto query = [&measurements, &spursData] {
+    spursData.clear();
+    return measurements.QuerySpuriousList(spursData);
+  };
+  Stub::Backend().DefaultReply = Stub::MakeSpuriousList(spurs, false);
+  Bench::Run("transfer_spurious_list_ascii", std::to_string(spursNum),
+             spursNum, query);
+  if (Bench::Setup("transfer_spurious_list_real64",
+                   measurements.ConfigureDataFormat(
+                       Measurements::DataFormat::Real64))) {
+    Stub::Backend().DefaultReply = Stub::MakeSpuriousList(spurs, true);
+    Bench::Run("transfer_spurious_list_real64", std::to_string(spursNum),
+               spursNum, query);
+  }
+  ssa.Close();
+}
+
+void BenchSpuriousResultsCopy() {
+  namespace Types = AgXSAn::SA::SpuriousEmissions::Types;
+  Stub::Reset();
+  Stub::Backend().IsWriteLogged = false;
+  AgXSAn::CAgXSAn xsan{};
+  if (!Bench::Setup("fetch_spurious_results",
+                    xsan.Connect("TCPIP0::xsan::INSTR",
+                                 AgXSAn::CAgXSAnOptions{}))) {
+    return;
+  }
+  const auto &trace = xsan.SA.SpuriousEmissions.Trace;
+  Types::CSpursView spursView{};
+  for (const auto spursNum : SpursNums) {
+    Stub::Backend().Trace =
+        Stub::MakeSpuriousTrace(Stub::GenerateSpurs(spursNum, SpursSeed));
+    Bench::Run("fetch_spurious_results", std::to_string(spursNum), spursNum,
+               [&trace, &spursView] {
+                 return trace.FetchSpuriousResults(spursView);
+               });
+  }
+  xsan.Close();
+}
+
+void BenchConnect() {
+  CIviDriverOptions driverOptions{};
+  driverOptions.RangeCheck = false;
+  driverOptions.Cache = true;
+  driverOptions.QueryInstrStatus = false;
+  driverOptions.RecordCoercions = false;
+  driverOptions.DriverSetup = {{"TraceArraySize", "4096"}};
+  Bench::Run("make_options_string", "all_options", 1, [&driverOptions] {
+    Bench::g_Sink = Bench::g_Sink +
+                    IviOptions::MakeString(driverOptions, true, "E5052B")
+                        .size();
+    return VI_SUCCESS;
+  });
+  Stub::Reset();
+  AgSsa::CAgSsaOptions options{};
+  static_cast<CIviDriverOptions &>(options) = driverOptions;
+  options.Model = AgSsa::AgSsaModel::E5052B;
+  AgSsa::CAgSsa ssa{};
+  Bench::Run("connect", "AgSsa", 1, [&ssa, &options] {
+    const auto status = ssa.Connect("TCPIP0::ssa::INSTR", options);
+    ssa.Close();
+    return status;
+  });
+}
+
+// Per-call cost of the init options with every instrument access taking
+// IoLatency. The stub models the driver's Cache and QueryInstrStatus (see
+// Stub::CBackend); RangeCheck only costs driver CPU time, which the stub
+// does not have.
+void BenchInitOptions() {
+  struct CCase {
+    const char *Name;
+    std::optional<bool> RangeCheck;
+    std::optional<bool> Cache;
+    std::optional<bool> QueryInstrStatus;
+    bool AttributeCache;
+  };
+  const std::array<CCase, 4> cases{
+      {{"query_instr_status", {}, false, true, false},
+       {"cache_off", {}, false, false, false},
+       {"production", false, true, false, false},
+       {"production_wrapper_cache", false, true, false, true}}};
+  for (const auto &benchCase : cases) {
+    Stub::Reset();
+    Stub::Backend().IsWriteLogged = false;
+    Stub::Backend().IoLatency = std::chrono::microseconds{50};
+    AgSsa::CAgSsaOptions options{};
+    options.RangeCheck = benchCase.RangeCheck;
+    options.Cache = benchCase.Cache;
+    options.QueryInstrStatus = benchCase.QueryInstrStatus;
+    options.AttributeCache = benchCase.AttributeCache;
+    AgSsa::CAgSsa ssa{};
+    if (!Bench::Setup(benchCase.Name,
+                      ssa.Connect("TCPIP0::ssa::INSTR", options))) {
+      continue;
+    }
+    Bench::Run("configure_same_value", benchCase.Name, 1,
+               [&ssa] { return ssa.Display.ConfigureMaximize(true); });
+    bool isMaximized{};
+    Bench::Run("configure_new_value", benchCase.Name, 1, [&ssa, &isMaximized] {
+      isMaximized = !isMaximized;
+      return ssa.Display.ConfigureMaximize(isMaximized);
+    });
+    int correlation{};
+    Bench::Run("query", benchCase.Name, 1, [&ssa, &correlation] {
+      return ssa.Application.PN.Aquisition.QueryCorrelation(correlation);
+    });
+    ssa.Close();
+  }
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  Bench::Init(argc, argv);
+  BenchFacades();
+  BenchSpuriousListParse();
+  BenchSpuriousListTransfer();
+  BenchSpuriousResultsCopy();
+  BenchConnect();
+  BenchInitOptions();
+  return Bench::Result();
+}
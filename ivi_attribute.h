@@ -0,0 +1,155 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef IVI_ATTRIBUTE_H
+#define IVI_ATTRIBUTE_H
+
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+#include "IviVisaType.h"
+#include "visa.h"
+
+struct CIviAnyValue {
+  template <typename RawType>
+  static constexpr bool Contains(RawType) noexcept {
+    return true;
+  }
+};
+
+// Valid-value set of an attribute, e.g. the enumerators of its value type.
+template <auto... values>
+struct CIviValueSet {
+  template <typename RawType>
+  static constexpr bool Contains(RawType raw) noexcept {
+    return ((raw == static_cast<RawType>(values)) || ...);
+  }
+};
+
+// Compile-time description of a driver attribute: ID, the type the wrapper
+// exposes, the type the driver transfers (ViBoolean, ViInt32 or ViReal64),
+// the valid values, the repeated capability and the SCPI header the value is
+// programmed with. Descriptors needing a repeated capability or a header
+// derive from it and hide RepCap or Command:
+//   struct CWindowScale
+//       : CIviAttribute<ATTR_WINDOW_SCALE, ViReal64> {
+//     static constexpr ViConstString RepCap{"Window1"};
+//     static constexpr std::string_view Command{":DISP:WIND1:Y:PDIV"};
+//   };
+// Only descriptors with a Command can be recorded into a batch.
+template <ViAttr id, typename Value, typename Raw = Value,
+          typename ValidValues = CIviAnyValue>
+struct CIviAttribute {
+  using ValueType = Value;
+  using RawType = Raw;
+  static constexpr ViAttr Id{id};
+  static constexpr ViConstString RepCap{nullptr};
+  static constexpr std::string_view Command{};
+  static constexpr bool IsValid(RawType raw) noexcept {
+    return ValidValues::Contains(raw);
+  }
+  static constexpr RawType ToRaw(ValueType value) noexcept {
+    return static_cast<RawType>(value);
+  }
+  static constexpr ValueType FromRaw(RawType raw) noexcept {
+    if constexpr (std::is_enum_v<ValueType>) {
+      return static_cast<ValueType>(
+          static_cast<std::underlying_type_t<ValueType>>(raw));
+    } else {
+      return static_cast<ValueType>(raw);
+    }
+  }
+};
+
+namespace IviAttribute {
+
+// Writes a group of attributes with set(repCap, id, raw) for each. All values
+// are validated before anything is sent, so an invalid one leaves the
+// instrument untouched; the first failing write ends the group.
+template <typename... Descriptors, typename Setter>
+ViStatus Set(Setter &&set,
+             const typename Descriptors::ValueType &... values) noexcept {
+  if (!(Descriptors::IsValid(Descriptors::ToRaw(values)) && ...)) {
+    return VI_ERROR_NSUP_ATTR_STATE;
+  }
+  ViStatus status{VI_SUCCESS};
+  auto write = [&status, &set](auto descriptor, const auto &value) {
+    using Descriptor = decltype(descriptor);
+    status = set(Descriptor::RepCap, Descriptor::Id, Descriptor::ToRaw(value));
+    return (status == VI_SUCCESS);
+  };
+  (write(Descriptors{}, values) && ...);
+  return status;
+}
+
+// Records a group of attributes with record(command, raw) for each instead
+// of writing them. The group fails as a whole with VI_ERROR_NSUP_OPER when a
+// descriptor has no SCPI header, before anything is recorded.
+template <typename... Descriptors, typename Recorder>
+ViStatus Record(Recorder &&record,
+                const typename Descriptors::ValueType &... values) noexcept {
+  if (!(Descriptors::IsValid(Descriptors::ToRaw(values)) && ...)) {
+    return VI_ERROR_NSUP_ATTR_STATE;
+  }
+  if (!(!Descriptors::Command.empty() && ...)) return VI_ERROR_NSUP_OPER;
+  try {
+    (record(Descriptors::Command, Descriptors::ToRaw(values)), ...);
+  } catch (...) {
+    return VI_ERROR_ALLOC;
+  }
+  return VI_SUCCESS;
+}
+
+// Reads a group of attributes with get(repCap, id, raw &) for each. Values
+// outside the valid-value set fail with VI_ERROR_INV_RESPONSE; the outputs
+// are only written once every attribute has been read and validated.
+template <typename... Descriptors, typename Getter>
+ViStatus Get(Getter &&get,
+             typename Descriptors::ValueType &... values) noexcept {
+  ViStatus status{VI_SUCCESS};
+  auto read = [&status, &get](auto descriptor, auto &raw) {
+    using Descriptor = decltype(descriptor);
+    status = get(Descriptor::RepCap, Descriptor::Id, raw);
+    if ((status == VI_SUCCESS) && !Descriptor::IsValid(raw)) {
+      status = VI_ERROR_INV_RESPONSE;
+    }
+    return (status == VI_SUCCESS);
+  };
+  std::tuple<typename Descriptors::RawType...> raws{};
+  std::apply(
+      [&read](auto &... raw) { (read(Descriptors{}, raw) && ...); }, raws);
+  if (status != VI_SUCCESS) return status;
+  std::apply(
+      [&values...](const auto &... raw) {
+        ((values = Descriptors::FromRaw(raw)), ...);
+      },
+      raws);
+  return status;
+}
+
+}  // namespace IviAttribute
+
+#endif  // IVI_ATTRIBUTE_H
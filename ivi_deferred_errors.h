@@ -0,0 +1,121 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef IVI_DEFERRED_ERRORS_H
+#define IVI_DEFERRED_ERRORS_H
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "IviVisaType.h"
+
+// One entry of the instrument error queue drained at the end of a deferred
+// error sequence. Call is the index of the journaled driver call it most
+// likely came from, NoCall if the sequence made no matching call.
+struct CIviDeferredError {
+  static constexpr std::size_t NoCall{std::numeric_limits<std::size_t>::max()};
+  ViInt32 Code{};
+  std::string Description{};
+  std::size_t Call{NoCall};
+  std::string_view Function{};
+};
+
+// Driver calls made while instrument status checking is deferred, in call
+// order.
+class CIviCallJournal {
+ public:
+  struct CEntry {
+    std::string_view Function{};
+    ViStatus Status{};
+  };
+
+ private:
+  std::vector<CEntry> m_Entries{};
+
+  static bool IsQuery(std::string_view function) noexcept {
+    constexpr std::array<std::string_view, 4> words{"Get", "Read", "Fetch",
+                                                    "Query"};
+    for (const auto word : words) {
+      if (function.find(word) != std::string_view::npos) return true;
+    }
+    return false;
+  }
+  // SCPI query errors are -400..-499; everything else is raised by commands.
+  static bool IsQueryError(ViInt32 code) noexcept {
+    return (code <= -400) && (code > -500);
+  }
+  std::size_t Find(std::size_t end, bool isQuery, bool isFailed) const
+      noexcept {
+    while (end > 0) {
+      const auto &entry = m_Entries[--end];
+      if ((IsQuery(entry.Function) == isQuery) &&
+          (!isFailed || (entry.Status != VI_SUCCESS))) {
+        return end;
+      }
+    }
+    return CIviDeferredError::NoCall;
+  }
+
+ public:
+  // A call that cannot be stored for the lack of memory is left out.
+  void Record(std::string_view function, ViStatus status) noexcept {
+    try {
+      m_Entries.push_back(CEntry{function, status});
+    } catch (...) {
+    }
+  }
+  // Keeps the capacity and makes sure room for capacity calls is reserved,
+  // so a typical sequence records without allocating.
+  void Clear(std::size_t capacity = 256) noexcept {
+    m_Entries.clear();
+    try {
+      m_Entries.reserve(capacity);
+    } catch (...) {
+    }
+  }
+  const std::vector<CEntry> &GetEntries() const noexcept { return m_Entries; }
+  // The queue is FIFO, so errors are matched from the last one backwards,
+  // each to a call no later than the one matched to the error after it.
+  // A call of the error's kind (query or command) the driver already
+  // reported as failed is preferred, otherwise the latest one is taken.
+  void Attribute(std::vector<CIviDeferredError> &errors) const noexcept {
+    std::size_t end{m_Entries.size()};
+    for (auto error = errors.rbegin(); error != errors.rend(); ++error) {
+      const bool isQuery{IsQueryError(error->Code)};
+      auto call = Find(end, isQuery, true);
+      if (call == CIviDeferredError::NoCall) call = Find(end, isQuery, false);
+      error->Call = call;
+      if (call == CIviDeferredError::NoCall) continue;
+      error->Function = m_Entries[call].Function;
+      end = call + 1;
+    }
+  }
+};
+
+#endif  // IVI_DEFERRED_ERRORS_H
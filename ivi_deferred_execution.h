@@ -0,0 +1,106 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef IVI_DEFERRED_EXECUTION_H
+#define IVI_DEFERRED_EXECUTION_H
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "IviVisaType.h"
+#include "visa.h"
+
+#include "ivi_deferred_errors.h"
+#include "ivi_inner_session.h"
+#include "ivi_scpi.h"
+
+// Runs driver call sequences with the driver's per-call instrument status
+// query turned off and drains the error queue once at the end. Io provides,
+// besides the raw Write and Read of CIviOperation and the attribute access
+// of CIviState:
+//   static constexpr ViAttr QueryInstrumentStatus;  // the driver attribute
+template <typename Io>
+class CIviDeferredExecution {
+  inline static constexpr std::size_t ErrorQueueMax{100};
+
+ public:
+  // Runs sequence (ViStatus()) and maps each queued error to the driver
+  // call that most likely caused it. The sequence owns the session, see
+  // CIviInnerSession::StartJournal().
+  template <typename Sequence>
+  static ViStatus Execute(CIviInnerSession &session, Sequence &&sequence,
+                          std::vector<CIviDeferredError> &errors) noexcept {
+    ViBoolean isQueryEnabled{};
+    auto status = Io::GetAttribute(session, nullptr, Io::QueryInstrumentStatus,
+                                   isQueryEnabled);
+    if (status != VI_SUCCESS) return status;
+    status = Io::SetAttribute(session, nullptr, Io::QueryInstrumentStatus,
+                              ViBoolean{VI_FALSE});
+    if (status != VI_SUCCESS) return status;
+    errors.clear();
+    try {
+      auto &journal = session.StartJournal();
+      status = sequence();
+      session.StopJournal();
+      const auto drainStatus = Drain(session, errors);
+      if (status == VI_SUCCESS) status = drainStatus;
+      journal.Attribute(errors);
+    } catch (...) {
+      session.StopJournal();
+      status = VI_ERROR_ALLOC;
+    }
+    const auto restoreStatus = Io::SetAttribute(
+        session, nullptr, Io::QueryInstrumentStatus, isQueryEnabled);
+    return (status == VI_SUCCESS) ? restoreStatus : status;
+  }
+  // Reads :SYST:ERR? until the queue reports no error.
+  static ViStatus Drain(CIviInnerSession &session,
+                        std::vector<CIviDeferredError> &errors) {
+    std::array<ViChar, 256> response{};
+    for (std::size_t idx{}; idx < ErrorQueueMax; ++idx) {
+      auto status = Io::Write(session, ":SYST:ERR?");
+      if (status != VI_SUCCESS) return status;
+      std::size_t responseSize{};
+      status = Scpi::ReadResponse(
+          [&session](ViChar *buf, ViInt64 size, ViInt64 *retSize) {
+            return Io::Read(session, buf, size, retSize);
+          },
+          response, responseSize);
+      if (status != VI_SUCCESS) return status;
+      ViInt32 code{};
+      std::string_view description{};
+      status = Scpi::ParseErrorResponse(response.data(), responseSize, code,
+                                        description);
+      if ((status != VI_SUCCESS) || (code == 0)) return status;
+      errors.push_back(CIviDeferredError{code, std::string{description}});
+    }
+    return VI_SUCCESS;
+  }
+};
+
+#endif  // IVI_DEFERRED_EXECUTION_H
@@ -26,14 +26,335 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef IVI_INNER_SESSION_H
 #define IVI_INNER_SESSION_H
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <variant>
+#include <vector>
+
 #include "IviVisaType.h"
 
+#include "ivi_deferred_errors.h"
+#include "ivi_profiler.h"
+#include "ivi_scpi.h"
+
+struct CIviInnerSession;
+
+// Write-through shadow of attribute values keyed by attribute ID and repeated
+// capability. Writes of already known values and reads of known values are
+// served without a bus round trip. The driver may coerce a written value, so
+// a write only suppresses writing the same value again; reads are served
+// from values read back from the instrument. Whole tables uploaded by a
+// single driver function are shadowed as raw bytes keyed by the function
+// name. Anything that may change the instrument state behind the wrapper's
+// back must call Invalidate().
+class CIviAttributeCache {
+ public:
+  using ValueType = std::variant<ViBoolean, ViInt32, ViReal64>;
+  using TableFunctionType = void (*)();
+  // Re-uploads a shadowed table through the driver function it came from.
+  using TableApplyType = ViStatus (*)(CIviInnerSession &, std::string_view,
+                                      TableFunctionType, std::string_view);
+  struct CTable {
+    std::string Bytes{};
+    TableFunctionType Function{};
+    TableApplyType Apply{};
+  };
+  struct CValue {
+    std::string RepCap{};
+    ViAttr Id{};
+    ValueType Value{};
+  };
+  // Settings in the layout the cache shadows them in, see CIviStateSnapshot.
+  struct CSnapshot {
+    std::vector<CValue> Values{};
+    std::vector<std::pair<std::string_view, CTable>> Tables{};
+  };
+  struct CStatistics {
+    std::uint64_t Hits{};
+    std::uint64_t Misses{};
+  };
+
+ private:
+  // Repeated capabilities are interned, so keys hold views and lookups
+  // with the caller's string do not allocate.
+  struct CKey {
+    ViAttr Id{};
+    std::string_view RepCap{};
+    bool operator==(const CKey &other) const noexcept {
+      return (Id == other.Id) && (RepCap == other.RepCap);
+    }
+  };
+  struct CKeyHash {
+    std::size_t operator()(const CKey &key) const noexcept {
+      return std::hash<std::string_view>{}(key.RepCap) ^ std::size_t(key.Id);
+    }
+  };
+  struct CEntry {
+    ValueType Value{};
+    // Read back from the instrument, as opposed to the value last written.
+    bool IsRead{};
+  };
+  std::unordered_map<CKey, CEntry, CKeyHash> m_Values{};
+  std::unordered_map<std::string_view, CTable> m_Tables{};
+  std::unordered_set<std::string_view> m_RepCaps{};
+  std::deque<std::string> m_RepCapsStorage{};
+  CStatistics m_Statistics{};
+  bool m_Enabled{};
+  static CKey MakeKey(ViConstString repCap, ViAttr id) noexcept {
+    return CKey{id, (repCap == nullptr) ? std::string_view{}
+                                        : std::string_view{repCap}};
+  }
+  std::string_view Intern(std::string_view repCap) {
+    auto found = m_RepCaps.find(repCap);
+    if (found != m_RepCaps.end()) return *found;
+    const std::string_view interned{m_RepCapsStorage.emplace_back(repCap)};
+    m_RepCaps.insert(interned);
+    return interned;
+  }
+  // A value that cannot be shadowed for the lack of memory is forgotten.
+  void Assign(CKey key, const ValueType &value, bool isRead) noexcept {
+    try {
+      auto found = m_Values.find(key);
+      if (found == m_Values.end()) {
+        key.RepCap = Intern(key.RepCap);
+        found = m_Values.emplace(key, CEntry{}).first;
+      }
+      found->second = CEntry{value, isRead};
+    } catch (...) {
+      m_Values.erase(key);
+    }
+  }
+  template <typename Type>
+  static std::string_view TableBytes(const Type *data, std::size_t size) {
+    static_assert(std::is_trivially_copyable_v<Type>,
+                  "Table type is not supported!");
+    return std::string_view(reinterpret_cast<const char *>(data),
+                            size * sizeof(Type));
+  }
+
+ public:
+  void Enable(bool enabled = true) noexcept {
+    m_Enabled = enabled;
+    Invalidate();
+  }
+  bool IsEnabled() const noexcept { return m_Enabled; }
+  template <typename Type>
+  bool Contains(ViConstString repCap, ViAttr id, const Type &value) noexcept {
+    if (!m_Enabled) return false;
+    auto found = m_Values.find(MakeKey(repCap, id));
+    if ((found != m_Values.end()) &&
+        std::holds_alternative<Type>(found->second.Value) &&
+        (std::get<Type>(found->second.Value) == value)) {
+      ++m_Statistics.Hits;
+      return true;
+    }
+    ++m_Statistics.Misses;
+    return false;
+  }
+  template <typename Type>
+  bool Lookup(ViConstString repCap, ViAttr id, Type &value) noexcept {
+    if (!m_Enabled) return false;
+    auto found = m_Values.find(MakeKey(repCap, id));
+    if ((found != m_Values.end()) && found->second.IsRead &&
+        std::holds_alternative<Type>(found->second.Value)) {
+      value = std::get<Type>(found->second.Value);
+      ++m_Statistics.Hits;
+      return true;
+    }
+    ++m_Statistics.Misses;
+    return false;
+  }
+  // Value was written; a later Lookup still goes to the instrument.
+  template <typename Type>
+  void Store(ViConstString repCap, ViAttr id, const Type &value) noexcept {
+    if (!m_Enabled) return;
+    Assign(MakeKey(repCap, id), ValueType{value}, false);
+  }
+  // Value was read back from the instrument.
+  template <typename Type>
+  void StoreRead(ViConstString repCap, ViAttr id, const Type &value) noexcept {
+    if (!m_Enabled) return;
+    Assign(MakeKey(repCap, id), ValueType{value}, true);
+  }
+  void Invalidate(ViConstString repCap, ViAttr id) noexcept {
+    m_Values.erase(MakeKey(repCap, id));
+  }
+  // Table names are expected to be string literals, they are stored by
+  // reference.
+  template <typename Type>
+  bool ContainsTable(std::string_view name, const Type *data,
+                     std::size_t size) noexcept {
+    if (!m_Enabled) return false;
+    auto found = m_Tables.find(name);
+    if ((found != m_Tables.end()) &&
+        (found->second.Bytes == TableBytes(data, size))) {
+      ++m_Statistics.Hits;
+      return true;
+    }
+    ++m_Statistics.Misses;
+    return false;
+  }
+  template <typename Type>
+  void StoreTable(std::string_view name, TableFunctionType function,
+                  TableApplyType apply, const Type *data,
+                  std::size_t size) noexcept {
+    if (!m_Enabled) return;
+    // A table that cannot be shadowed is forgotten, its old bytes would
+    // skip the next upload.
+    try {
+      auto &table = m_Tables[name];
+      table.Bytes.assign(TableBytes(data, size));
+      table.Function = function;
+      table.Apply = apply;
+    } catch (...) {
+      m_Tables.erase(name);
+    }
+  }
+  void InvalidateTable(std::string_view name) noexcept { m_Tables.erase(name); }
+  void Invalidate() noexcept {
+    m_Values.clear();
+    m_Tables.clear();
+  }
+  // Takes over a snapshot the instrument is known to be in (e.g. right
+  // after recalling it).
+  void Restore(const CSnapshot &snapshot) {
+    if (!m_Enabled) return;
+    Invalidate();
+    for (const auto &value : snapshot.Values) {
+      Assign(CKey{value.Id, value.RepCap}, value.Value, true);
+    }
+    m_Tables.insert(snapshot.Tables.begin(), snapshot.Tables.end());
+  }
+  const CStatistics &GetStatistics() const noexcept { return m_Statistics; }
+  void ResetStatistics() noexcept { m_Statistics = CStatistics{}; }
+};
+
+// Every setting the wrapper manages, as read back from the instrument.
+// When Register is set the same state is also stored in that instrument
+// state register (*SAV), so recalling it is a single *RCL.
+struct CIviStateSnapshot {
+  CIviAttributeCache::CSnapshot Settings{};
+  std::optional<ViInt32> Register{};
+};
+
+// Transfer format of list queries as last configured with :FORM.
+struct CIviDataFormat {
+  bool IsReal64{};
+  Scpi::ByteOrder ByteOrder{Scpi::ByteOrder::Normal};
+};
+
+struct CIviInnerSession {
+  ViSession Handle{};
+  CIviAttributeCache AttributeCache{};
+  CIviDataFormat DataFormat{};
+  // Active profiler and journal, null when off. The objects live as long as
+  // the session, so a call in flight on another thread keeps a valid one
+  // even while they are switched off.
+  std::atomic<CIviCallProfiler *> Profiler{};
+  std::atomic<CIviCallJournal *> Journal{};
+  std::unique_ptr<CIviCallProfiler> ProfilerStorage{};
+  CIviCallJournal JournalStorage{};
+  // Batch the Configure* calls are recorded into, null when not recording.
+  std::atomic<Scpi::CScpiBatch *> Recording{};
+
+  // Every driver call goes through here. Without a profiler or a journal
+  // the call is made directly; with a profiler, the call latency and status
+  // are recorded per function, with a journal the call itself is recorded.
+  // While recording a batch, driver calls are refused: they would reach the
+  // instrument ahead of the recorded commands.
+  template <typename Function, typename... Args>
+  ViStatus Invoke(std::string_view function, Function &&call,
+                  Args &&... args) noexcept {
+    if (Recording.load(std::memory_order_relaxed) != nullptr) {
+      return VI_ERROR_NSUP_OPER;
+    }
+    auto *const profiler = Profiler.load(std::memory_order_acquire);
+    auto *const journal = Journal.load(std::memory_order_acquire);
+    if (!profiler && !journal) return call(std::forward<Args>(args)...);
+    const auto begin = std::chrono::steady_clock::now();
+    const ViStatus status = call(std::forward<Args>(args)...);
+    if (profiler) {
+      profiler->Record(function, std::chrono::steady_clock::now() - begin,
+                       status);
+    }
+    if (journal) journal->Record(function, status);
+    return status;
+  }
+  // Forgets everything assumed about the instrument settings. Anything that
+  // may change them behind the wrapper's back (*RST, *RCL, raw SCPI,
+  // reconnects) must call this. The transfer format is kept: only :FORM,
+  // a reset and a new session change it.
+  void Invalidate() noexcept { AttributeCache.Invalidate(); }
+  // The instrument is back in its reset state (*RST, new or closed
+  // session): the settings are forgotten and lists are transferred in
+  // ASCII again.
+  void Revert() noexcept {
+    Invalidate();
+    DataFormat = CIviDataFormat{};
+  }
+  void CountBytes(std::string_view function, std::uint64_t bytes) noexcept {
+    auto *const profiler = Profiler.load(std::memory_order_acquire);
+    if (profiler) profiler->RecordBytes(function, bytes);
+  }
+  // May be called while other threads use the session, but not from two
+  // threads at once. Enabling again starts from empty statistics.
+  void EnableProfiling(bool enabled = true) {
+    if (!enabled) {
+      Profiler.store(nullptr, std::memory_order_release);
+      return;
+    }
+    if (Profiler.load(std::memory_order_acquire) != nullptr) return;
+    if (ProfilerStorage) {
+      ProfilerStorage->Reset();
+    } else {
+      ProfilerStorage = std::make_unique<CIviCallProfiler>();
+    }
+    Profiler.store(ProfilerStorage.get(), std::memory_order_release);
+  }
+  // Journals the driver calls of a deferred error sequence. The sequence
+  // owns the session: calls from other threads meanwhile would be mixed
+  // into the journal.
+  CIviCallJournal &StartJournal() noexcept {
+    JournalStorage.Clear();
+    Journal.store(&JournalStorage, std::memory_order_release);
+    return JournalStorage;
+  }
+  void StopJournal() noexcept {
+    Journal.store(nullptr, std::memory_order_release);
+  }
+};
+
+// Base of the wrapper facades. It takes the whole inner session rather than
+// only its ViSession handle (as it did before the attribute cache and the
+// profiler were added), so facades constructed outside the wrappers must be
+// given the CIviInnerSession of their instrument.
 class CIviInnerSessionReference {
  protected:
+  CIviInnerSession &m_InnerSession;
   ViSession &m_Session;
 
+  template <typename Function, typename... Args>
+  ViStatus Invoke(std::string_view function, Function &&call,
+                  Args &&... args) const noexcept {
+    return m_InnerSession.Invoke(function, std::forward<Function>(call),
+                                 std::forward<Args>(args)...);
+  }
+
  public:
-  CIviInnerSessionReference(ViSession &session) : m_Session{session} {}
+  CIviInnerSessionReference(CIviInnerSession &session)
+      : m_InnerSession{session}, m_Session{session.Handle} {}
   ~CIviInnerSessionReference() = default;
   CIviInnerSessionReference() = delete;
   CIviInnerSessionReference(const CIviInnerSessionReference &) = delete;
@@ -0,0 +1,249 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef IVI_OPERATION_H
+#define IVI_OPERATION_H
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include "IviVisaType.h"
+#include "visa.h"
+
+#include "ivi_inner_session.h"
+#include "ivi_scpi.h"
+
+namespace Visa {
+
+inline ViStatus EnableServiceRequest(ViSession io, bool enabled) noexcept {
+  if (!enabled) return viDisableEvent(io, VI_EVENT_SERVICE_REQ, VI_QUEUE);
+  viDiscardEvents(io, VI_EVENT_SERVICE_REQ, VI_QUEUE);
+  return viEnableEvent(io, VI_EVENT_SERVICE_REQ, VI_QUEUE, VI_NULL);
+}
+
+inline ViStatus WaitForServiceRequest(ViSession io, ViUInt32 timeout,
+                                      ViUInt16 &statusByte) noexcept {
+  ViEventType eventType{};
+  ViEvent event{};
+  auto status =
+      viWaitOnEvent(io, VI_EVENT_SERVICE_REQ, timeout, &eventType, &event);
+  if (status < VI_SUCCESS) return status;
+  viClose(event);
+  return viReadSTB(io, &statusByte);
+}
+
+inline ViStatus ReadStatusByte(ViSession io, ViUInt16 &statusByte) noexcept {
+  return viReadSTB(io, &statusByte);
+}
+
+}  // namespace Visa
+
+// Polling asks *ESR? every poll interval. ServiceRequest routes the OPC bit
+// to SRQ (adds bit 0 to *ESE and bit 5 to *SRE), so Wait() sleeps in the
+// VISA event queue and wakes up as soon as the sweep ends. The previous
+// enable masks are restored once the operation completes, is cancelled or
+// destroyed.
+// The status enable masks are no driver attributes, so writing them leaves
+// the driver's attribute cache valid.
+enum class CompletionMode { Polling, ServiceRequest };
+
+// Completion token of a measurement started without waiting for it. The
+// instrument is asked to set the OPC bit of the event status register when
+// the sweep is done; Poll() reads that register and never blocks, so a single
+// thread can drive several instruments. Io provides the driver raw I/O:
+//   static ViStatus Write(CIviInnerSession &, ViConstString);
+//   static ViStatus Read(CIviInnerSession &, ViChar *, ViInt64, ViInt64 *);
+//   static ViStatus EnableServiceRequest(CIviInnerSession &, bool);
+//   static ViStatus WaitForServiceRequest(CIviInnerSession &, ViUInt32,
+//                                         ViUInt16 &);
+template <typename Io>
+class CIviOperation {
+ public:
+  using AbortType = ViStatus (*)(CIviInnerSession &);
+
+ private:
+  CIviInnerSession *m_InnerSession{};
+  AbortType m_Abort{};
+  CompletionMode m_Mode{CompletionMode::Polling};
+  bool m_IsStarted{};
+  bool m_IsComplete{};
+  bool m_IsServiceRequestEnabled{};
+  ViInt32 m_EventEnable{};
+  ViInt32 m_ServiceRequestEnable{};
+
+  ViStatus QueryInteger(ViConstString query, ViInt32 &value) const noexcept {
+    auto status = Io::Write(*m_InnerSession, query);
+    if (status != VI_SUCCESS) return status;
+    std::array<ViChar, 16> response{};
+    std::size_t responseSize{};
+    status = Scpi::ReadResponse(
+        [this](ViChar *buf, ViInt64 size, ViInt64 *retSize) {
+          return Io::Read(*m_InnerSession, buf, size, retSize);
+        },
+        response, responseSize);
+    if (status != VI_SUCCESS) return status;
+    return Scpi::ParseInteger(response.data(), responseSize, value);
+  }
+  ViStatus QueryEventStatus(ViInt32 &value) const noexcept {
+    return QueryInteger("*ESR?", value);
+  }
+  ViStatus WriteEnableMasks(ViInt32 eventEnable,
+                            ViInt32 serviceRequestEnable) const noexcept {
+    std::array<ViChar, 48> command{};
+    auto *pos = command.data();
+    auto *const end = command.data() + command.size() - 1;
+    auto append = [&pos, end](std::string_view text) {
+      const auto size = std::min(text.size(), std::size_t(end - pos));
+      pos = std::copy_n(text.begin(), size, pos);
+    };
+    append("*ESE ");
+    pos = std::to_chars(pos, end, eventEnable).ptr;
+    append(";*SRE ");
+    pos = std::to_chars(pos, end, serviceRequestEnable).ptr;
+    return Io::Write(*m_InnerSession, command.data());
+  }
+  ViStatus EnableServiceRequest() noexcept {
+    auto status = QueryInteger("*ESE?", m_EventEnable);
+    if (status != VI_SUCCESS) return status;
+    status = QueryInteger("*SRE?", m_ServiceRequestEnable);
+    if (status != VI_SUCCESS) return status;
+    status = WriteEnableMasks(m_EventEnable | 1, m_ServiceRequestEnable | 32);
+    if (status != VI_SUCCESS) return status;
+    m_IsServiceRequestEnabled = true;
+    status = Io::EnableServiceRequest(*m_InnerSession, true);
+    if (status != VI_SUCCESS) DisableServiceRequest();
+    return status;
+  }
+  void DisableServiceRequest() noexcept {
+    if (!m_IsServiceRequestEnabled) return;
+    Io::EnableServiceRequest(*m_InnerSession, false);
+    WriteEnableMasks(m_EventEnable, m_ServiceRequestEnable);
+    m_IsServiceRequestEnabled = false;
+  }
+  ViStatus WaitForServiceRequest(
+      const std::chrono::steady_clock::time_point &deadline) noexcept {
+    for (;;) {
+      bool isComplete{};
+      auto status = Poll(isComplete);
+      if ((status != VI_SUCCESS) || isComplete) return status;
+      const auto now = std::chrono::steady_clock::now();
+      if (now >= deadline) return VI_ERROR_TMO;
+      const auto timeout =
+          std::chrono::duration_cast<std::chrono::milliseconds>(deadline -
+                                                                now);
+      ViUInt16 statusByte{};
+      status = Io::WaitForServiceRequest(
+          *m_InnerSession, ViUInt32(timeout.count()) + 1, statusByte);
+      if (status != VI_SUCCESS) return status;
+    }
+  }
+
+ public:
+  CIviOperation() = default;
+  CIviOperation(CIviInnerSession &session, AbortType abort,
+                CompletionMode mode = CompletionMode::Polling) noexcept
+      : m_InnerSession{&session}, m_Abort{abort}, m_Mode{mode} {}
+  CIviOperation(const CIviOperation &) = delete;
+  CIviOperation &operator=(const CIviOperation &) = delete;
+  CIviOperation(CIviOperation &&other) noexcept { *this = std::move(other); }
+  CIviOperation &operator=(CIviOperation &&other) noexcept {
+    if (this != &other) {
+      if (m_InnerSession != nullptr) DisableServiceRequest();
+      m_InnerSession = other.m_InnerSession;
+      m_Abort = other.m_Abort;
+      m_Mode = other.m_Mode;
+      m_IsStarted = other.m_IsStarted;
+      m_IsComplete = other.m_IsComplete;
+      m_IsServiceRequestEnabled =
+          std::exchange(other.m_IsServiceRequestEnabled, false);
+      m_EventEnable = other.m_EventEnable;
+      m_ServiceRequestEnable = other.m_ServiceRequestEnable;
+    }
+    return *this;
+  }
+  ~CIviOperation() {
+    if (m_InnerSession != nullptr) DisableServiceRequest();
+  }
+  template <typename Initiate>
+  ViStatus Start(Initiate &&initiate) noexcept {
+    if (m_InnerSession == nullptr) return VI_ERROR_INV_OBJECT;
+    m_IsStarted = false;
+    m_IsComplete = false;
+    DisableServiceRequest();
+    ViInt32 eventStatus{};
+    auto status = QueryEventStatus(eventStatus);
+    if (status != VI_SUCCESS) return status;
+    if (m_Mode == CompletionMode::ServiceRequest) {
+      status = EnableServiceRequest();
+      if (status != VI_SUCCESS) return status;
+    }
+    status = initiate();
+    if (status == VI_SUCCESS) status = Io::Write(*m_InnerSession, "*OPC");
+    m_IsStarted = (status == VI_SUCCESS);
+    if (!m_IsStarted) DisableServiceRequest();
+    return status;
+  }
+  ViStatus Poll(bool &isComplete) noexcept {
+    if (!m_IsStarted) return VI_ERROR_INV_OBJECT;
+    if (!m_IsComplete) {
+      ViInt32 eventStatus{};
+      auto status = QueryEventStatus(eventStatus);
+      if (status != VI_SUCCESS) return status;
+      m_IsComplete = ((eventStatus & 1) != 0);
+      if (m_IsComplete) DisableServiceRequest();
+    }
+    isComplete = m_IsComplete;
+    return VI_SUCCESS;
+  }
+  ViStatus Wait(const std::chrono::milliseconds &timeout,
+                const std::chrono::milliseconds &pollInterval =
+                    std::chrono::milliseconds{10}) noexcept {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    if (m_IsServiceRequestEnabled) return WaitForServiceRequest(deadline);
+    bool isComplete{};
+    for (;;) {
+      auto status = Poll(isComplete);
+      if ((status != VI_SUCCESS) || isComplete) return status;
+      if (std::chrono::steady_clock::now() >= deadline) return VI_ERROR_TMO;
+      std::this_thread::sleep_for(pollInterval);
+    }
+  }
+  ViStatus Cancel() noexcept {
+    if (!m_IsStarted) return VI_ERROR_INV_OBJECT;
+    m_IsStarted = false;
+    DisableServiceRequest();
+    if (m_IsComplete || (m_Abort == nullptr)) return VI_SUCCESS;
+    return m_Abort(*m_InnerSession);
+  }
+  bool IsStarted() const noexcept { return m_IsStarted; }
+  bool IsComplete() const noexcept { return m_IsComplete; }
+};
+
+#endif  // IVI_OPERATION_H
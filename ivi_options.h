@@ -0,0 +1,144 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef IVI_OPTIONS_H
+#define IVI_OPTIONS_H
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// IVI inherent init options. Unset ones are left out of the option string,
+// so the driver defaults apply. In production RangeCheck and
+// QueryInstrStatus off plus Cache on save most of the per-call driver
+// overhead. DriverSetup keys are passed through as Key=Value.
+struct CIviDriverOptions {
+  std::optional<bool> RangeCheck{};
+  std::optional<bool> Cache{};
+  std::optional<bool> QueryInstrStatus{};
+  std::optional<bool> RecordCoercions{};
+  std::vector<std::pair<std::string, std::string>> DriverSetup{};
+  bool operator==(const CIviDriverOptions &other) const noexcept {
+    return (RangeCheck == other.RangeCheck) && (Cache == other.Cache) &&
+           (QueryInstrStatus == other.QueryInstrStatus) &&
+           (RecordCoercions == other.RecordCoercions) &&
+           (DriverSetup == other.DriverSetup);
+  }
+  bool operator!=(const CIviDriverOptions &other) const noexcept {
+    return !(*this == other);
+  }
+};
+
+namespace IviOptions {
+
+namespace Detail {
+
+inline void AppendFlag(std::string &options, std::string_view name,
+                       bool value) {
+  if (!options.empty()) options += ", ";
+  options += name;
+  options += value ? "=true" : "=false";
+}
+
+inline void AppendFlag(std::string &options, std::string_view name,
+                       const std::optional<bool> &value) {
+  if (value) AppendFlag(options, name, *value);
+}
+
+template <typename COptions, typename = void>
+struct HasAttributeCache : std::false_type {};
+
+template <typename COptions>
+struct HasAttributeCache<
+    COptions,
+    std::void_t<decltype(std::declval<const COptions &>().AttributeCache)>>
+    : std::true_type {};
+
+}  // namespace Detail
+
+// Used by the converting constructors of the wrapper options: option structs
+// of the caller without the driver options or the AttributeCache flag still
+// convert, and get the defaults for them.
+template <typename COptions>
+CIviDriverOptions DriverOptionsOf(const COptions &options) {
+  if constexpr (std::is_convertible_v<const COptions &,
+                                      const CIviDriverOptions &>) {
+    return options;
+  } else {
+    return CIviDriverOptions{};
+  }
+}
+
+template <typename COptions>
+bool AttributeCacheOf(const COptions &options) noexcept {
+  if constexpr (Detail::HasAttributeCache<COptions>::value) {
+    return options.AttributeCache;
+  } else {
+    return false;
+  }
+}
+
+// Builds "RangeCheck=..., ..., Simulate=..., DriverSetup=Model=..., Key=..."
+// in one buffer. DriverSetup goes last since it takes the rest of the
+// string; an empty model is left out.
+inline std::string MakeString(const CIviDriverOptions &driverOptions,
+                              bool simulate, std::string_view model) {
+  std::size_t size{128 + model.size()};
+  for (const auto &setup : driverOptions.DriverSetup) {
+    size += setup.first.size() + setup.second.size() + 3;
+  }
+  std::string options{};
+  options.reserve(size);
+  Detail::AppendFlag(options, "RangeCheck", driverOptions.RangeCheck);
+  Detail::AppendFlag(options, "Cache", driverOptions.Cache);
+  Detail::AppendFlag(options, "QueryInstrStatus",
+                     driverOptions.QueryInstrStatus);
+  Detail::AppendFlag(options, "RecordCoercions",
+                     driverOptions.RecordCoercions);
+  Detail::AppendFlag(options, "Simulate", simulate);
+  if (model.empty() && driverOptions.DriverSetup.empty()) return options;
+  options += ", DriverSetup=";
+  bool isFirst{true};
+  if (!model.empty()) {
+    options += "Model=";
+    options += model;
+    isFirst = false;
+  }
+  for (const auto &setup : driverOptions.DriverSetup) {
+    if (!isFirst) options += ", ";
+    options += setup.first;
+    options += '=';
+    options += setup.second;
+    isFirst = false;
+  }
+  return options;
+}
+
+}  // namespace IviOptions
+
+#endif  // IVI_OPTIONS_H
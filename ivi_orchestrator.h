@@ -0,0 +1,192 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef IVI_ORCHESTRATOR_H
+#define IVI_ORCHESTRATOR_H
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "IviVisaType.h"
+
+// Owns several instrument sessions (CAgSsa, CAgXSAn, ...) and runs the tasks
+// submitted for them on a worker pool. Tasks of one instrument form a strand
+// and run strictly in submission order, one at a time; tasks of different
+// instruments run in parallel, so a station takes about as long as its
+// slowest instrument.
+class CIviOrchestrator {
+ public:
+  using ClockType = std::chrono::steady_clock;
+  template <typename Instrument>
+  struct CInstrument {
+    Instrument &Instance;
+    std::size_t Index;
+  };
+  struct CUtilization {
+    std::string Name{};
+    std::uint64_t Tasks{};
+    ClockType::duration Busy{};
+    ClockType::duration Elapsed{};
+    double Ratio() const noexcept {
+      return (Elapsed.count() == 0) ? 0.0
+                                    : double(Busy.count()) / Elapsed.count();
+    }
+  };
+
+ private:
+  struct CStrand {
+    std::string Name{};
+    std::shared_ptr<void> Instrument{};
+    std::deque<std::function<void()>> Tasks{};
+    bool IsScheduled{};
+    std::uint64_t TasksDone{};
+    ClockType::duration Busy{};
+  };
+  std::mutex m_Mutex{};
+  std::condition_variable m_Ready{};
+  std::condition_variable m_Idle{};
+  std::vector<std::unique_ptr<CStrand>> m_Strands{};
+  std::deque<CStrand *> m_ReadyStrands{};
+  std::vector<std::thread> m_Workers{};
+  std::size_t m_Pending{};
+  bool m_IsStopping{};
+  ClockType::time_point m_Start{ClockType::now()};
+
+  void Run() {
+    std::unique_lock<std::mutex> lock{m_Mutex};
+    for (;;) {
+      m_Ready.wait(lock,
+                   [this] { return m_IsStopping || !m_ReadyStrands.empty(); });
+      if (m_ReadyStrands.empty()) return;
+      CStrand *strand{m_ReadyStrands.front()};
+      m_ReadyStrands.pop_front();
+      auto task = std::move(strand->Tasks.front());
+      strand->Tasks.pop_front();
+      lock.unlock();
+      const auto begin = ClockType::now();
+      task();
+      const auto busy = ClockType::now() - begin;
+      lock.lock();
+      strand->Busy += busy;
+      ++strand->TasksDone;
+      --m_Pending;
+      if (strand->Tasks.empty()) {
+        strand->IsScheduled = false;
+      } else {
+        m_ReadyStrands.push_back(strand);
+        m_Ready.notify_one();
+      }
+      if (m_Pending == 0) m_Idle.notify_all();
+    }
+  }
+
+ public:
+  static std::size_t DefaultWorkersNum() noexcept {
+    return std::max(1U, std::thread::hardware_concurrency());
+  }
+  explicit CIviOrchestrator(std::size_t workersNum = DefaultWorkersNum()) {
+    for (std::size_t idx{}; idx < workersNum; ++idx) {
+      m_Workers.emplace_back([this] { Run(); });
+    }
+  }
+  ~CIviOrchestrator() {
+    {
+      std::lock_guard<std::mutex> lock{m_Mutex};
+      m_IsStopping = true;
+    }
+    m_Ready.notify_all();
+    for (auto &worker : m_Workers) worker.join();
+  }
+  CIviOrchestrator(const CIviOrchestrator &) = delete;
+  CIviOrchestrator(CIviOrchestrator &&) = delete;
+  CIviOrchestrator &operator=(const CIviOrchestrator &) = delete;
+  CIviOrchestrator &operator=(CIviOrchestrator &&) = delete;
+
+  template <typename Instrument>
+  CInstrument<Instrument> Add(const std::string &name) {
+    auto instance = std::make_shared<Instrument>();
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    auto strand = std::make_unique<CStrand>();
+    strand->Name = name;
+    strand->Instrument = instance;
+    m_Strands.push_back(std::move(strand));
+    return CInstrument<Instrument>{*instance, m_Strands.size() - 1};
+  }
+  // Task is ViStatus(Instrument &); it runs after every task submitted
+  // earlier for the same instrument has finished.
+  template <typename Instrument, typename Task>
+  std::future<ViStatus> Submit(const CInstrument<Instrument> &instrument,
+                               Task &&task) {
+    auto packagedTask = std::make_shared<std::packaged_task<ViStatus()>>(
+        [&instance = instrument.Instance,
+         task = std::forward<Task>(task)]() mutable { return task(instance); });
+    auto future = packagedTask->get_future();
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    CStrand &strand{*m_Strands.at(instrument.Index)};
+    strand.Tasks.emplace_back([packagedTask] { (*packagedTask)(); });
+    ++m_Pending;
+    if (!strand.IsScheduled) {
+      strand.IsScheduled = true;
+      m_ReadyStrands.push_back(&strand);
+      m_Ready.notify_one();
+    }
+    return future;
+  }
+  void WaitAll() {
+    std::unique_lock<std::mutex> lock{m_Mutex};
+    m_Idle.wait(lock, [this] { return m_Pending == 0; });
+  }
+  std::vector<CUtilization> GetUtilization() {
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    const auto elapsed = ClockType::now() - m_Start;
+    std::vector<CUtilization> utilization{};
+    utilization.reserve(m_Strands.size());
+    for (const auto &strand : m_Strands) {
+      utilization.push_back(
+          CUtilization{strand->Name, strand->TasksDone, strand->Busy, elapsed});
+    }
+    return utilization;
+  }
+  void ResetUtilization() {
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    m_Start = ClockType::now();
+    for (auto &strand : m_Strands) {
+      strand->TasksDone = 0;
+      strand->Busy = ClockType::duration{};
+    }
+  }
+};
+
+#endif  // IVI_ORCHESTRATOR_H
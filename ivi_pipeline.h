@@ -0,0 +1,146 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef IVI_PIPELINE_H
+#define IVI_PIPELINE_H
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "IviVisaType.h"
+#include "visa.h"
+
+// Runs repeated measurements so that the instrument never waits for the
+// host: as soon as the results of sweep N are transferred the next sweep is
+// initiated, and sweep N is processed on a worker thread while sweep N+1
+// runs. A single worker thread serves the whole Run. Results alternate
+// between two buffers; a buffer is reused only after its processing has
+// finished, so the buffers keep their capacity and no results are copied.
+template <typename Results>
+class CIviPipeline {
+  std::array<Results, 2> m_Buffers{};
+
+  // Hands one sweep at a time to the worker thread and collects its status.
+  class CWorker {
+    std::mutex m_Mutex{};
+    std::condition_variable m_Condition{};
+    std::size_t m_SweepIdx{};
+    bool m_HasJob{};
+    bool m_IsQuit{};
+    ViStatus m_Status{VI_SUCCESS};
+    std::thread m_Thread{};
+
+   public:
+    template <typename Process>
+    ViStatus Start(std::array<Results, 2> &buffers,
+                   Process &process) noexcept {
+      try {
+        m_Thread = std::thread{[this, &buffers, &process] {
+          std::unique_lock<std::mutex> lock{m_Mutex};
+          while (true) {
+            m_Condition.wait(lock, [this] { return m_HasJob || m_IsQuit; });
+            if (!m_HasJob) break;
+            const auto sweepIdx = m_SweepIdx;
+            lock.unlock();
+            ViStatus status{};
+            try {
+              status = ViStatus(process(
+                  std::as_const(buffers[sweepIdx % buffers.size()]),
+                  sweepIdx));
+            } catch (...) {
+              status = VI_ERROR_SYSTEM_ERROR;
+            }
+            lock.lock();
+            m_Status = status;
+            m_HasJob = false;
+            m_Condition.notify_all();
+          }
+        }};
+      } catch (...) {
+        return VI_ERROR_SYSTEM_ERROR;
+      }
+      return VI_SUCCESS;
+    }
+    void Post(std::size_t sweepIdx) noexcept {
+      {
+        std::lock_guard<std::mutex> lock{m_Mutex};
+        m_SweepIdx = sweepIdx;
+        m_HasJob = true;
+      }
+      m_Condition.notify_all();
+    }
+    // Waits for the posted sweep, if any, and returns its status.
+    ViStatus Finish() noexcept {
+      std::unique_lock<std::mutex> lock{m_Mutex};
+      m_Condition.wait(lock, [this] { return !m_HasJob; });
+      return std::exchange(m_Status, VI_SUCCESS);
+    }
+    ~CWorker() {
+      {
+        std::lock_guard<std::mutex> lock{m_Mutex};
+        m_IsQuit = true;
+      }
+      m_Condition.notify_all();
+      if (m_Thread.joinable()) m_Thread.join();
+    }
+  };
+
+ public:
+  // Initiate and Wait are ViStatus(), Fetch is ViStatus(Results &) and
+  // Process is ViStatus(const Results &, std::size_t sweepIdx). Stops at the
+  // first failure; a sweep initiated before it is left running.
+  template <typename Initiate, typename Wait, typename Fetch, typename Process>
+  ViStatus Run(std::size_t sweepsNum, Initiate &&initiate, Wait &&wait,
+               Fetch &&fetch, Process &&process) noexcept {
+    if (sweepsNum == 0) return VI_SUCCESS;
+    CWorker worker{};
+    auto status = worker.Start(m_Buffers, process);
+    if (status != VI_SUCCESS) return status;
+    status = initiate();
+    if (status != VI_SUCCESS) return status;
+    for (std::size_t sweepIdx{}; sweepIdx < sweepsNum; ++sweepIdx) {
+      auto &buffer = m_Buffers[sweepIdx % m_Buffers.size()];
+      status = wait();
+      if (status != VI_SUCCESS) break;
+      // The buffer was last handed out two sweeps ago, its processing has
+      // been collected below in the previous iteration.
+      status = fetch(buffer);
+      if (status != VI_SUCCESS) break;
+      if (sweepIdx + 1 < sweepsNum) status = initiate();
+      const auto processStatus = worker.Finish();
+      if (status == VI_SUCCESS) status = processStatus;
+      if (status != VI_SUCCESS) break;
+      worker.Post(sweepIdx);
+    }
+    const auto processStatus = worker.Finish();
+    return (status == VI_SUCCESS) ? processStatus : status;
+  }
+};
+
+#endif  // IVI_PIPELINE_H
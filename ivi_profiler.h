@@ -0,0 +1,175 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef IVI_PROFILER_H
+#define IVI_PROFILER_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "IviVisaType.h"
+
+// Log-linear latency histogram in nanoseconds (HDR style): values below 16 ns
+// are counted exactly, every following power of two is split into 16 equal
+// sub-buckets, so any recorded value is within 1/16 of its bucket bound.
+class CIviLatencyHistogram {
+  inline static constexpr std::size_t SubBucketsBits{4};
+  inline static constexpr std::size_t SubBucketsNum{1U << SubBucketsBits};
+  inline static constexpr std::size_t BucketsNum{(64 - SubBucketsBits + 1) *
+                                                 SubBucketsNum};
+  std::array<std::uint64_t, BucketsNum> m_Counts{};
+  std::uint64_t m_TotalCount{};
+
+  static std::size_t BucketIndex(std::uint64_t value) noexcept {
+    if (value < SubBucketsNum) return std::size_t(value);
+    std::size_t exponent{};
+    for (auto rest = value; rest > 1; rest >>= 1) ++exponent;
+    const std::size_t shift{exponent - SubBucketsBits};
+    return (shift + 1) * SubBucketsNum +
+           std::size_t((value >> shift) & (SubBucketsNum - 1));
+  }
+  static std::uint64_t BucketValue(std::size_t index) noexcept {
+    if (index < SubBucketsNum) return index;
+    const std::size_t shift{index / SubBucketsNum - 1};
+    return (std::uint64_t(SubBucketsNum + index % SubBucketsNum) << shift);
+  }
+
+ public:
+  void Record(std::uint64_t nanoseconds) noexcept {
+    ++m_Counts[BucketIndex(nanoseconds)];
+    ++m_TotalCount;
+  }
+  std::uint64_t TotalCount() const noexcept { return m_TotalCount; }
+  // Lower bound of the bucket holding the given percentile (0...100).
+  std::uint64_t Percentile(double percentile) const noexcept {
+    if (m_TotalCount == 0) return 0;
+    const auto rank = std::uint64_t(percentile / 100.0 * m_TotalCount);
+    std::uint64_t count{};
+    for (std::size_t idx{}; idx < m_Counts.size(); ++idx) {
+      count += m_Counts[idx];
+      if ((count > rank) || (count == m_TotalCount)) return BucketValue(idx);
+    }
+    return BucketValue(m_Counts.size() - 1);
+  }
+};
+
+struct CIviCallStatistics {
+  std::string_view Function{};
+  std::uint64_t Calls{};
+  std::uint64_t Errors{};
+  std::uint64_t Bytes{};
+  std::uint64_t TotalNanoseconds{};
+  std::uint64_t MinNanoseconds{std::numeric_limits<std::uint64_t>::max()};
+  std::uint64_t MaxNanoseconds{};
+  ViStatus LastError{};
+  CIviLatencyHistogram Latency{};
+};
+
+// Per-session call counters. Function names are expected to be string
+// literals, they are stored by reference.
+class CIviCallProfiler {
+  mutable std::mutex m_Mutex{};
+  std::unordered_map<std::string_view, CIviCallStatistics> m_Statistics{};
+
+  // Null when the statistics of a new function cannot be allocated, the
+  // sample is dropped then.
+  CIviCallStatistics *Find(std::string_view function) noexcept {
+    try {
+      auto &statistics = m_Statistics[function];
+      statistics.Function = function;
+      return &statistics;
+    } catch (...) {
+      return nullptr;
+    }
+  }
+
+ public:
+  // Room for the functions a session typically calls, so recording rarely
+  // allocates.
+  CIviCallProfiler() { m_Statistics.reserve(64); }
+  void Record(std::string_view function, std::chrono::nanoseconds duration,
+              ViStatus status) noexcept {
+    const auto nanoseconds = std::uint64_t(duration.count());
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    auto *const found = Find(function);
+    if (found == nullptr) return;
+    auto &statistics = *found;
+    ++statistics.Calls;
+    if (status < VI_SUCCESS) {
+      ++statistics.Errors;
+      statistics.LastError = status;
+    }
+    statistics.TotalNanoseconds += nanoseconds;
+    if (nanoseconds < statistics.MinNanoseconds) {
+      statistics.MinNanoseconds = nanoseconds;
+    }
+    if (nanoseconds > statistics.MaxNanoseconds) {
+      statistics.MaxNanoseconds = nanoseconds;
+    }
+    statistics.Latency.Record(nanoseconds);
+  }
+  void RecordBytes(std::string_view function, std::uint64_t bytes) noexcept {
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    auto *const statistics = Find(function);
+    if (statistics != nullptr) statistics->Bytes += bytes;
+  }
+  std::vector<CIviCallStatistics> Snapshot() const {
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    std::vector<CIviCallStatistics> snapshot{};
+    snapshot.reserve(m_Statistics.size());
+    for (const auto &statistics : m_Statistics) {
+      snapshot.push_back(statistics.second);
+    }
+    return snapshot;
+  }
+  void Reset() noexcept {
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    m_Statistics.clear();
+  }
+  // One CSV line per function, latencies in nanoseconds.
+  void Export(std::ostream &stream) const {
+    stream << "function,calls,errors,bytes,total,min,p50,p90,p99,max\n";
+    for (const auto &statistics : Snapshot()) {
+      stream << statistics.Function << ',' << statistics.Calls << ','
+             << statistics.Errors << ',' << statistics.Bytes << ','
+             << statistics.TotalNanoseconds << ','
+             << ((statistics.Calls == 0) ? 0 : statistics.MinNanoseconds)
+             << ',' << statistics.Latency.Percentile(50) << ','
+             << statistics.Latency.Percentile(90) << ','
+             << statistics.Latency.Percentile(99) << ','
+             << statistics.MaxNanoseconds << '\n';
+    }
+  }
+};
+
+#endif  // IVI_PROFILER_H
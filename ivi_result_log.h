@@ -0,0 +1,328 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef IVI_RESULT_LOG_H
+#define IVI_RESULT_LOG_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "IviVisaType.h"
+#include "visa.h"
+
+// Append-only binary log of fixed size result records (CSpurData,
+// CCarrierData, ...). The file is a CIviResultLogHeader followed by entries,
+// each a CIviResultLogEntry and the raw bytes of one record. All records of
+// one Append() share the sequence number and the timestamp, both of which
+// never decrease, so the reader finds them by binary search.
+struct CIviResultLogHeader {
+  inline static constexpr std::array<char, 8> MagicValue{'I', 'V', 'I', 'R',
+                                                         'L', 'O', 'G', '1'};
+  std::array<char, 8> Magic{MagicValue};
+  std::uint32_t RecordSize{};
+  std::uint32_t Reserved{};
+};
+
+struct CIviResultLogEntry {
+  std::uint64_t Sequence{};
+  // Nanoseconds since the system clock epoch.
+  std::int64_t Timestamp{};
+};
+
+template <typename Record>
+class CIviResultLogWriter {
+  static_assert(std::is_trivially_copyable_v<Record>,
+                "Record type is not supported!");
+  inline static constexpr std::size_t EntrySize{sizeof(CIviResultLogEntry) +
+                                                sizeof(Record)};
+  std::FILE *m_File{};
+  std::uint64_t m_Sequence{};
+  std::int64_t m_Timestamp{};
+
+ public:
+  CIviResultLogWriter() = default;
+  CIviResultLogWriter(const CIviResultLogWriter &) = delete;
+  CIviResultLogWriter &operator=(const CIviResultLogWriter &) = delete;
+  ~CIviResultLogWriter() { Close(); }
+  // Creates the log or continues an existing one. A partially written last
+  // entry (e.g. after a crash) is overwritten.
+  ViStatus Open(const std::string &path) noexcept {
+    Close();
+    m_File = std::fopen(path.c_str(), "rb+");
+    if (m_File == nullptr) m_File = std::fopen(path.c_str(), "wb+");
+    if (m_File == nullptr) return VI_ERROR_SYSTEM_ERROR;
+    CIviResultLogHeader header{};
+    if (std::fread(&header, sizeof(header), 1, m_File) == 1) {
+      if ((header.Magic != CIviResultLogHeader::MagicValue) ||
+          (header.RecordSize != sizeof(Record))) {
+        Close();
+        return VI_ERROR_INV_SETUP;
+      }
+    } else {
+      header = CIviResultLogHeader{};
+      header.RecordSize = sizeof(Record);
+      if ((std::fseek(m_File, 0, SEEK_SET) != 0) ||
+          (std::fwrite(&header, sizeof(header), 1, m_File) != 1)) {
+        Close();
+        return VI_ERROR_SYSTEM_ERROR;
+      }
+    }
+    if (std::fseek(m_File, 0, SEEK_END) != 0) {
+      Close();
+      return VI_ERROR_SYSTEM_ERROR;
+    }
+    const auto fileSize = std::ftell(m_File);
+    const auto entriesNum =
+        std::size_t(fileSize - long(sizeof(header))) / EntrySize;
+    const auto end = long(sizeof(header) + entriesNum * EntrySize);
+    m_Sequence = 0;
+    m_Timestamp = 0;
+    if (entriesNum != 0) {
+      CIviResultLogEntry entry{};
+      if ((std::fseek(m_File, end - long(EntrySize), SEEK_SET) != 0) ||
+          (std::fread(&entry, sizeof(entry), 1, m_File) != 1)) {
+        Close();
+        return VI_ERROR_SYSTEM_ERROR;
+      }
+      m_Sequence = entry.Sequence + 1;
+      m_Timestamp = entry.Timestamp;
+    }
+    if (std::fseek(m_File, end, SEEK_SET) != 0) {
+      Close();
+      return VI_ERROR_SYSTEM_ERROR;
+    }
+    return VI_SUCCESS;
+  }
+  void Close() noexcept {
+    if (m_File != nullptr) std::fclose(m_File);
+    m_File = nullptr;
+  }
+  bool IsOpen() const noexcept { return m_File != nullptr; }
+  // Sequence number the next Append() will use.
+  std::uint64_t NextSequence() const noexcept { return m_Sequence; }
+  ViStatus Append(const Record *records, std::size_t recordsNum) noexcept {
+    if (m_File == nullptr) return VI_ERROR_INV_OBJECT;
+    // Clock steps back (e.g. NTP) must not break the time index.
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    m_Timestamp = std::max(
+        m_Timestamp,
+        std::int64_t(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now).count()));
+    const CIviResultLogEntry entry{m_Sequence, m_Timestamp};
+    for (std::size_t idx{}; idx < recordsNum; ++idx) {
+      if ((std::fwrite(&entry, sizeof(entry), 1, m_File) != 1) ||
+          (std::fwrite(&records[idx], sizeof(Record), 1, m_File) != 1)) {
+        return VI_ERROR_SYSTEM_ERROR;
+      }
+    }
+    ++m_Sequence;
+    return VI_SUCCESS;
+  }
+  ViStatus Append(const Record &record) noexcept {
+    return Append(&record, 1);
+  }
+  // Any contiguous container of records (std::vector, views, ...).
+  template <typename Records>
+  ViStatus Append(const Records &records) noexcept {
+    return Append(records.data(), records.size());
+  }
+  ViStatus Flush() noexcept {
+    if (m_File == nullptr) return VI_ERROR_INV_OBJECT;
+    return (std::fflush(m_File) == 0) ? VI_SUCCESS : VI_ERROR_SYSTEM_ERROR;
+  }
+};
+
+// Maps the whole log into memory; opening costs the same for any file size
+// and entries are read in place.
+template <typename Record>
+class CIviResultLogReader {
+  static_assert(std::is_trivially_copyable_v<Record>,
+                "Record type is not supported!");
+  inline static constexpr std::size_t EntrySize{sizeof(CIviResultLogEntry) +
+                                                sizeof(Record)};
+  const unsigned char *m_Data{};
+  std::size_t m_MappedSize{};
+  std::size_t m_Size{};
+#if defined(_WIN32)
+  HANDLE m_File{INVALID_HANDLE_VALUE};
+  HANDLE m_Mapping{};
+#endif
+
+  const unsigned char *EntryData(std::size_t idx) const noexcept {
+    return m_Data + sizeof(CIviResultLogHeader) + idx * EntrySize;
+  }
+  template <typename Key, typename Compare>
+  std::size_t LowerBound(Key key, Compare &&isLess) const noexcept {
+    std::size_t first{};
+    std::size_t count{m_Size};
+    while (count != 0) {
+      const std::size_t step{count / 2};
+      if (isLess(GetEntry(first + step), key)) {
+        first += step + 1;
+        count -= step + 1;
+      } else {
+        count = step;
+      }
+    }
+    return first;
+  }
+
+ public:
+  CIviResultLogReader() = default;
+  CIviResultLogReader(const CIviResultLogReader &) = delete;
+  CIviResultLogReader &operator=(const CIviResultLogReader &) = delete;
+  ~CIviResultLogReader() { Close(); }
+  ViStatus Open(const std::string &path) noexcept {
+    Close();
+#if defined(_WIN32)
+    m_File = CreateFileA(path.c_str(), GENERIC_READ,
+                         FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_File == INVALID_HANDLE_VALUE) return VI_ERROR_SYSTEM_ERROR;
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(m_File, &fileSize)) {
+      Close();
+      return VI_ERROR_SYSTEM_ERROR;
+    }
+    m_MappedSize = std::size_t(fileSize.QuadPart);
+    if (m_MappedSize < sizeof(CIviResultLogHeader)) {
+      Close();
+      return VI_ERROR_INV_SETUP;
+    }
+    m_Mapping =
+        CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_Mapping == nullptr) {
+      Close();
+      return VI_ERROR_SYSTEM_ERROR;
+    }
+    m_Data = static_cast<const unsigned char *>(
+        MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_Data == nullptr) {
+      Close();
+      return VI_ERROR_SYSTEM_ERROR;
+    }
+#else
+    const int file{::open(path.c_str(), O_RDONLY)};
+    if (file < 0) return VI_ERROR_SYSTEM_ERROR;
+    struct stat fileStat {};
+    if (::fstat(file, &fileStat) != 0) {
+      ::close(file);
+      return VI_ERROR_SYSTEM_ERROR;
+    }
+    m_MappedSize = std::size_t(fileStat.st_size);
+    if (m_MappedSize < sizeof(CIviResultLogHeader)) {
+      ::close(file);
+      m_MappedSize = 0;
+      return VI_ERROR_INV_SETUP;
+    }
+    void *data{::mmap(nullptr, m_MappedSize, PROT_READ, MAP_SHARED, file, 0)};
+    ::close(file);
+    if (data == MAP_FAILED) {
+      m_MappedSize = 0;
+      return VI_ERROR_SYSTEM_ERROR;
+    }
+    m_Data = static_cast<const unsigned char *>(data);
+#endif
+    CIviResultLogHeader header{};
+    std::memcpy(&header, m_Data, sizeof(header));
+    if ((header.Magic != CIviResultLogHeader::MagicValue) ||
+        (header.RecordSize != sizeof(Record))) {
+      Close();
+      return VI_ERROR_INV_SETUP;
+    }
+    m_Size = (m_MappedSize - sizeof(header)) / EntrySize;
+    return VI_SUCCESS;
+  }
+  void Close() noexcept {
+#if defined(_WIN32)
+    if (m_Data != nullptr) UnmapViewOfFile(m_Data);
+    if (m_Mapping != nullptr) CloseHandle(m_Mapping);
+    if (m_File != INVALID_HANDLE_VALUE) CloseHandle(m_File);
+    m_Mapping = nullptr;
+    m_File = INVALID_HANDLE_VALUE;
+#else
+    if (m_Data != nullptr) {
+      ::munmap(const_cast<unsigned char *>(m_Data), m_MappedSize);
+    }
+#endif
+    m_Data = nullptr;
+    m_MappedSize = 0;
+    m_Size = 0;
+  }
+  bool IsOpen() const noexcept { return m_Data != nullptr; }
+  std::size_t Size() const noexcept { return m_Size; }
+  CIviResultLogEntry GetEntry(std::size_t idx) const noexcept {
+    CIviResultLogEntry entry{};
+    std::memcpy(&entry, EntryData(idx), sizeof(entry));
+    return entry;
+  }
+  Record GetRecord(std::size_t idx) const noexcept {
+    Record record{};
+    std::memcpy(&record, EntryData(idx) + sizeof(CIviResultLogEntry),
+                sizeof(record));
+    return record;
+  }
+  // Index of the first entry with a sequence number not less than sequence
+  // (Size() if there is none).
+  std::size_t FindSequence(std::uint64_t sequence) const noexcept {
+    return LowerBound(sequence,
+                      [](const CIviResultLogEntry &entry, std::uint64_t key) {
+                        return entry.Sequence < key;
+                      });
+  }
+  // Index of the first entry logged not earlier than time.
+  std::size_t FindTime(std::chrono::system_clock::time_point time) const
+      noexcept {
+    const std::int64_t timestamp{
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            time.time_since_epoch())
+            .count()};
+    return LowerBound(timestamp,
+                      [](const CIviResultLogEntry &entry, std::int64_t key) {
+                        return entry.Timestamp < key;
+                      });
+  }
+};
+
+#endif  // IVI_RESULT_LOG_H
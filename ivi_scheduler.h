@@ -0,0 +1,98 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef IVI_SCHEDULER_H
+#define IVI_SCHEDULER_H
+
+#include <chrono>
+#include <cstdint>
+
+// Predicts when a measurement started now will be complete from the sweep
+// time the instrument reports, so the host can sleep through the sweep and
+// fetch right after it instead of polling or waiting on a blanket timeout.
+// The instrument's estimate is scaled by a correction factor learned from
+// the observed completion times (exponential moving average).
+class CIviSweepScheduler {
+ public:
+  using ClockType = std::chrono::steady_clock;
+  struct CStatistics {
+    std::uint64_t Runs{};
+    // Runs already complete when the host woke up, i.e. fetched late.
+    std::uint64_t LateRuns{};
+    // Time spent waiting for completion after the wake up.
+    ClockType::duration Idle{};
+  };
+
+ private:
+  double m_Smoothing{};
+  double m_Guard{};
+  double m_Correction{1.0};
+  CStatistics m_Statistics{};
+
+  ClockType::duration Scale(ClockType::duration duration, double factor) const
+      noexcept {
+    return std::chrono::duration_cast<ClockType::duration>(
+        std::chrono::duration<double, ClockType::period>(duration.count() *
+                                                         factor));
+  }
+
+ public:
+  // guard is the fraction of the prediction the host wakes up early by.
+  explicit CIviSweepScheduler(double smoothing = 0.2,
+                              double guard = 0.05) noexcept
+      : m_Smoothing{smoothing}, m_Guard{guard} {}
+  ClockType::duration Predict(ClockType::duration expected) const noexcept {
+    return Scale(expected, m_Correction);
+  }
+  // How long after the start to sleep before waiting for completion.
+  ClockType::duration WakeUp(ClockType::duration expected) const noexcept {
+    return Scale(expected, m_Correction * (1.0 - m_Guard));
+  }
+  // elapsed runs from the start to the observed completion, idle from the
+  // wake up to the observed completion. isLate tells that a non-blocking
+  // check right at the wake up already found the run complete.
+  void Observe(ClockType::duration expected, ClockType::duration elapsed,
+               ClockType::duration idle, bool isLate) noexcept {
+    ++m_Statistics.Runs;
+    m_Statistics.Idle += idle;
+    if (expected.count() <= 0) return;
+    double sample{double(elapsed.count()) / double(expected.count())};
+    if (isLate) {
+      // Completed somewhere before the wake up: all that is known is that
+      // the prediction was too long, so pull it in by the guard.
+      ++m_Statistics.LateRuns;
+      sample *= 1.0 - m_Guard;
+    }
+    m_Correction += m_Smoothing * (sample - m_Correction);
+  }
+  double GetCorrection() const noexcept { return m_Correction; }
+  const CStatistics &GetStatistics() const noexcept { return m_Statistics; }
+  void Reset() noexcept {
+    m_Correction = 1.0;
+    m_Statistics = CStatistics{};
+  }
+};
+
+#endif  // IVI_SCHEDULER_H
@@ -0,0 +1,459 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef IVI_SCPI_H
+#define IVI_SCPI_H
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+#include "IviVisaType.h"
+#include "visa.h"
+
+namespace Scpi {
+
+// Streaming parser for comma separated <NR3> responses. Data may be fed in
+// arbitrary chunks as they come from viRead: a number split across chunk
+// boundary is kept in a small fixed buffer, so nothing is allocated per token.
+class CScpiRealListParser {
+  inline static constexpr std::size_t TokenMax{64};
+  std::array<ViChar, TokenMax> m_Token{};
+  std::size_t m_TokenSize{};
+
+  static bool IsSeparator(ViChar ch) noexcept {
+    return (ch == ',') || (ch == ';') || (ch == ' ') || (ch == '\t') ||
+           (ch == '\r') || (ch == '\n');
+  }
+  template <typename Sink>
+  static ViStatus ParseToken(const ViChar *first, const ViChar *last,
+                             Sink &sink) noexcept {
+    if ((first != last) && (*first == '+')) ++first;
+    ViReal64 value{};
+    auto result = std::from_chars(first, last, value);
+    if ((result.ec != std::errc{}) || (result.ptr != last)) {
+      return VI_ERROR_INV_RESPONSE;
+    }
+    return sink(value);
+  }
+
+ public:
+  void Reset() noexcept { m_TokenSize = 0; }
+  template <typename Sink>
+  ViStatus Consume(const ViChar *data, std::size_t size, Sink &&sink) noexcept {
+    const ViChar *end{data + size};
+    const ViChar *first{data};
+    for (const ViChar *pos{data}; pos != end; ++pos) {
+      if (!IsSeparator(*pos)) continue;
+      ViStatus status{VI_SUCCESS};
+      if (m_TokenSize != 0) {
+        if (m_TokenSize + std::size_t(pos - first) > TokenMax) {
+          return VI_ERROR_INV_RESPONSE;
+        }
+        std::copy(first, pos, m_Token.data() + m_TokenSize);
+        status = ParseToken(m_Token.data(),
+                            m_Token.data() + m_TokenSize + (pos - first), sink);
+        m_TokenSize = 0;
+      } else if (pos != first) {
+        status = ParseToken(first, pos, sink);
+      }
+      if (status != VI_SUCCESS) return status;
+      first = pos + 1;
+    }
+    const std::size_t tail(end - first);
+    if (m_TokenSize + tail > TokenMax) return VI_ERROR_INV_RESPONSE;
+    std::copy(first, end, m_Token.data() + m_TokenSize);
+    m_TokenSize += tail;
+    return VI_SUCCESS;
+  }
+  template <typename Sink>
+  ViStatus Finish(Sink &&sink) noexcept {
+    if (m_TokenSize == 0) return VI_SUCCESS;
+    auto status =
+        ParseToken(m_Token.data(), m_Token.data() + m_TokenSize, sink);
+    m_TokenSize = 0;
+    return status;
+  }
+};
+
+enum class ByteOrder { Normal, Swapped };
+
+inline bool IsLittleEndianHost() noexcept {
+  const ViUInt32 probe{1};
+  ViByte firstByte{};
+  std::memcpy(&firstByte, &probe, sizeof(firstByte));
+  return firstByte == 1;
+}
+
+// Byte order the host needs the instrument to send, so that blocks can be
+// used without swapping. Normal is IEEE 488.2 big-endian.
+inline ByteOrder HostByteOrder() noexcept {
+  return IsLittleEndianHost() ? ByteOrder::Swapped : ByteOrder::Normal;
+}
+
+inline void SwapBytes(ViReal64 *data, std::size_t size) noexcept {
+  for (std::size_t idx{}; idx < size; ++idx) {
+    std::array<ViByte, sizeof(ViReal64)> bytes{};
+    std::memcpy(bytes.data(), &data[idx], bytes.size());
+    std::reverse(bytes.begin(), bytes.end());
+    std::memcpy(&data[idx], bytes.data(), bytes.size());
+  }
+}
+
+// Reads an IEEE 488.2 definite length block "#<n><length><data><LF>".
+// Read is ViStatus(ViChar *buf, ViInt64 size, ViInt64 *retSize), Allocate is
+// ViChar *(std::size_t length) and returns the storage the payload is read
+// into (nullptr rejects the block). A read stopping at a termination
+// character inside the payload (VI_SUCCESS_TERM_CHAR) is continued, as only
+// END marks the end of the message.
+template <typename Read, typename Allocate>
+ViStatus ReadDefiniteLengthBlock(Read &&read, Allocate &&allocate) noexcept {
+  auto readExactly = [&read](ViChar *buf, std::size_t size) {
+    ViStatus status{VI_SUCCESS_MAX_CNT};
+    while (size != 0) {
+      ViInt64 retSize{};
+      status = read(buf, ViInt64(size), &retSize);
+      if (status == VI_SUCCESS_TERM_CHAR) status = VI_SUCCESS_MAX_CNT;
+      if ((status != VI_SUCCESS) && (status != VI_SUCCESS_MAX_CNT)) {
+        return status;
+      }
+      if ((retSize <= 0) ||
+          ((std::size_t(retSize) < size) && (status == VI_SUCCESS))) {
+        return ViStatus{VI_ERROR_INV_RESPONSE};
+      }
+      buf += retSize;
+      size -= std::size_t(retSize);
+    }
+    return status;
+  };
+  std::array<ViChar, 10> header{};
+  auto status = readExactly(header.data(), 2);
+  if (status != VI_SUCCESS_MAX_CNT) {
+    return (status == VI_SUCCESS) ? VI_ERROR_INV_RESPONSE : status;
+  }
+  if ((header[0] != '#') || (header[1] < '1') || (header[1] > '9')) {
+    return VI_ERROR_INV_RESPONSE;
+  }
+  const std::size_t digitsNum(header[1] - '0');
+  status = readExactly(header.data(), digitsNum);
+  if (status != VI_SUCCESS_MAX_CNT) {
+    return (status == VI_SUCCESS) ? VI_ERROR_INV_RESPONSE : status;
+  }
+  std::size_t length{};
+  auto result =
+      std::from_chars(header.data(), header.data() + digitsNum, length);
+  if ((result.ec != std::errc{}) || (result.ptr != header.data() + digitsNum)) {
+    return VI_ERROR_INV_RESPONSE;
+  }
+  ViChar *data{allocate(length)};
+  if ((data == nullptr) && (length != 0)) return VI_ERROR_INV_RESPONSE;
+  if (length != 0) {
+    status = readExactly(data, length);
+    if ((status != VI_SUCCESS) && (status != VI_SUCCESS_MAX_CNT)) {
+      return status;
+    }
+  }
+  if (status == VI_SUCCESS_MAX_CNT) {
+    ViInt64 retSize{};
+    status = read(header.data(), 1, &retSize);
+    if (status == VI_SUCCESS_TERM_CHAR) status = VI_SUCCESS;
+    if (status == VI_SUCCESS_MAX_CNT) status = VI_ERROR_INV_RESPONSE;
+  }
+  return status;
+}
+
+// Reads a short response into a fixed buffer. Whatever does not fit is read
+// and dropped, so the instrument output queue is always left empty.
+template <typename Read, std::size_t size>
+ViStatus ReadResponse(Read &&read, std::array<ViChar, size> &response,
+                      std::size_t &responseSize) noexcept {
+  std::array<ViChar, 64> dropBuf{};
+  ViStatus status{};
+  responseSize = 0;
+  do {
+    const bool isFull{responseSize == response.size()};
+    ViInt64 retSize{};
+    status = isFull ? read(dropBuf.data(), ViInt64(dropBuf.size()), &retSize)
+                    : read(response.data() + responseSize,
+                           ViInt64(response.size() - responseSize), &retSize);
+    if ((status != VI_SUCCESS) && (status != VI_SUCCESS_MAX_CNT)) {
+      return status;
+    }
+    if (!isFull) responseSize += std::size_t(retSize);
+  } while (status == VI_SUCCESS_MAX_CNT);
+  return status;
+}
+
+// Reads a response of unknown length into response, which keeps its capacity
+// between calls. When response cannot grow, the rest is read and dropped and
+// VI_ERROR_ALLOC is returned.
+template <typename Read>
+ViStatus ReadResponse(Read &&read, std::string &response) noexcept {
+  std::array<ViChar, 1024> buf{};
+  ViStatus status{};
+  bool isAllocated{true};
+  response.clear();
+  do {
+    ViInt64 retSize{};
+    status = read(buf.data(), ViInt64(buf.size()), &retSize);
+    if ((status != VI_SUCCESS) && (status != VI_SUCCESS_MAX_CNT)) {
+      return status;
+    }
+    if (!isAllocated) continue;
+    try {
+      response.append(buf.data(), std::size_t(retSize));
+    } catch (...) {
+      isAllocated = false;
+    }
+  } while (status == VI_SUCCESS_MAX_CNT);
+  return isAllocated ? status : ViStatus{VI_ERROR_ALLOC};
+}
+
+// Calls sink(index, data, size) for every ';' separated part of a compound
+// query response; the trailing terminator is dropped.
+template <typename Sink>
+ViStatus SplitResponse(const ViChar *data, std::size_t size, Sink &&sink) {
+  const ViChar *end{data + size};
+  while ((end != data) && ((end[-1] == '\n') || (end[-1] == '\r'))) --end;
+  std::size_t index{};
+  for (const ViChar *first{data};; ++index) {
+    const ViChar *last{std::find(first, end, ';')};
+    auto status = sink(index, first, std::size_t(last - first));
+    if (status != VI_SUCCESS) return status;
+    if (last == end) break;
+    first = last + 1;
+  }
+  return VI_SUCCESS;
+}
+
+inline ViStatus ParseInteger(const ViChar *data, std::size_t size,
+                             ViInt32 &value) noexcept {
+  const ViChar *first{data};
+  const ViChar *end{data + size};
+  while ((end != first) && ((end[-1] == '\n') || (end[-1] == '\r'))) --end;
+  if ((first != end) && (*first == '+')) ++first;
+  ViInt32 result{};
+  auto parsed = std::from_chars(first, end, result);
+  if ((parsed.ec != std::errc{}) || (parsed.ptr != end)) {
+    return VI_ERROR_INV_RESPONSE;
+  }
+  value = result;
+  return VI_SUCCESS;
+}
+
+// Null terminated command text of a fixed length, built at compile time by
+// Command() from literals and Index<>() suffixes, e.g.
+//   inline constexpr auto query{Command(":CALC:PN", Index<1>(), ":SPUR?")};
+// Sending it costs neither allocation nor formatting.
+template <std::size_t size>
+class CScpiCommand {
+  std::array<ViChar, size + 1> m_Data{};
+
+ public:
+  constexpr CScpiCommand() noexcept = default;
+  constexpr CScpiCommand(const ViChar (&text)[size + 1]) noexcept {
+    for (std::size_t idx{}; idx < size; ++idx) m_Data[idx] = text[idx];
+  }
+  constexpr CScpiCommand(const std::array<ViChar, size + 1> &text) noexcept
+      : m_Data{text} {}
+  template <std::size_t lhsSize, std::size_t rhsSize>
+  constexpr CScpiCommand(const CScpiCommand<lhsSize> &lhs,
+                         const CScpiCommand<rhsSize> &rhs) noexcept {
+    static_assert(lhsSize + rhsSize == size, "Command size mismatch!");
+    for (std::size_t idx{}; idx < lhsSize; ++idx) m_Data[idx] = lhs[idx];
+    for (std::size_t idx{}; idx < rhsSize; ++idx) {
+      m_Data[lhsSize + idx] = rhs[idx];
+    }
+  }
+  constexpr ViChar operator[](std::size_t idx) const noexcept {
+    return m_Data[idx];
+  }
+  constexpr std::size_t Size() const noexcept { return size; }
+  constexpr ViConstString c_str() const noexcept { return m_Data.data(); }
+  constexpr std::string_view View() const noexcept {
+    return std::string_view(m_Data.data(), size);
+  }
+  constexpr operator std::string_view() const noexcept { return View(); }
+};
+
+template <std::size_t size>
+CScpiCommand(const ViChar (&)[size]) -> CScpiCommand<size - 1>;
+
+namespace Detail {
+
+constexpr std::size_t DigitsNum(std::size_t value) noexcept {
+  std::size_t digitsNum{1};
+  while (value >= 10) {
+    value /= 10;
+    ++digitsNum;
+  }
+  return digitsNum;
+}
+
+template <std::size_t size>
+constexpr CScpiCommand<size - 1> MakeCommand(const ViChar (&text)[size]) {
+  return CScpiCommand<size - 1>(text);
+}
+template <std::size_t size>
+constexpr const CScpiCommand<size> &MakeCommand(
+    const CScpiCommand<size> &command) {
+  return command;
+}
+template <std::size_t size>
+constexpr CScpiCommand<size> Concat(const CScpiCommand<size> &command) {
+  return command;
+}
+template <std::size_t lhsSize, std::size_t rhsSize, typename... Tail>
+constexpr auto Concat(const CScpiCommand<lhsSize> &lhs,
+                      const CScpiCommand<rhsSize> &rhs, const Tail &... tail) {
+  return Concat(CScpiCommand<lhsSize + rhsSize>(lhs, rhs), tail...);
+}
+
+}  // namespace Detail
+
+// Decimal numeric suffix of a header (window, trace, subsystem...).
+template <std::size_t value>
+constexpr auto Index() noexcept {
+  constexpr auto digitsNum = Detail::DigitsNum(value);
+  std::array<ViChar, digitsNum + 1> digits{};
+  auto rest = value;
+  for (auto idx = digitsNum; idx > 0; --idx) {
+    digits[idx - 1] = ViChar('0' + rest % 10);
+    rest /= 10;
+  }
+  return CScpiCommand<digitsNum>(digits);
+}
+
+template <typename... Parts>
+constexpr auto Command(const Parts &... parts) {
+  return Detail::Concat(Detail::MakeCommand(parts)...);
+}
+
+// Collects configuration commands into a single program message, so a whole
+// setup sequence costs one write. The message is always terminated with
+// "*OPC?;:SYST:ERR?", so completion and the first queued error come back in
+// one read. Clear() keeps the capacity for the next batch.
+class CScpiBatch {
+  inline static constexpr std::string_view Suffix{"*OPC?;:SYST:ERR?"};
+  std::string m_Message{Suffix};
+  std::size_t m_Size{};
+
+  void Append(std::string_view text) {
+    m_Message.insert(m_Message.size() - Suffix.size(), text);
+  }
+  template <typename Value>
+  void AppendValue(Value value) {
+    std::array<ViChar, 32> buf{};
+    std::to_chars_result result{};
+    if constexpr (std::is_same_v<Value, bool>) {
+      buf[0] = value ? '1' : '0';
+      result.ptr = buf.data() + 1;
+    } else {
+      result = std::to_chars(buf.data(), buf.data() + buf.size(), value);
+    }
+    Append(std::string_view(buf.data(), std::size_t(result.ptr - buf.data())));
+  }
+
+ public:
+  CScpiBatch &Add(std::string_view command) {
+    if (command.empty()) return *this;
+    if ((command.front() != ':') && (command.front() != '*')) Append(":");
+    Append(command);
+    Append(";");
+    ++m_Size;
+    return *this;
+  }
+  template <typename Value>
+  CScpiBatch &Add(std::string_view header, Value value) {
+    if (header.empty()) return *this;
+    if ((header.front() != ':') && (header.front() != '*')) Append(":");
+    Append(header);
+    Append(" ");
+    AppendValue(value);
+    Append(";");
+    ++m_Size;
+    return *this;
+  }
+  void Clear() noexcept {
+    m_Message.erase(0, m_Message.size() - Suffix.size());
+    m_Size = 0;
+  }
+  bool IsEmpty() const noexcept { return m_Size == 0; }
+  std::size_t Size() const noexcept { return m_Size; }
+  ViConstString Message() const noexcept { return m_Message.c_str(); }
+};
+
+// Parses a "<code>,\"<description>\"" SYST:ERR? reply; description points
+// into data.
+inline ViStatus ParseErrorResponse(const ViChar *data, std::size_t size,
+                                   ViInt32 &errorCode,
+                                   std::string_view &description) noexcept {
+  const ViChar *first{data};
+  const ViChar *end{data + size};
+  if ((first != end) && (*first == '+')) ++first;
+  ViInt32 code{};
+  auto result = std::from_chars(first, end, code);
+  if ((result.ec != std::errc{}) ||
+      ((result.ptr != end) && (*result.ptr != ','))) {
+    return VI_ERROR_INV_RESPONSE;
+  }
+  description = std::string_view{};
+  const ViChar *open{std::find(result.ptr, end, '"')};
+  const ViChar *close{(open == end) ? end : std::find(open + 1, end, '"')};
+  if (close != end) {
+    description = std::string_view(open + 1, std::size_t(close - open - 1));
+  }
+  errorCode = code;
+  return VI_SUCCESS;
+}
+
+// Parses the "<opc>;<code>,\"<description>\"" reply of a batch. Anything
+// but 1 in the *OPC? field means the reply does not belong to the batch.
+inline ViStatus ParseBatchResponse(const ViChar *data, std::size_t size,
+                                   ViInt32 &errorCode,
+                                   std::string_view &description) noexcept {
+  const ViChar *end{data + size};
+  const ViChar *separator{std::find(data, end, ';')};
+  const ViChar *first{data};
+  if ((first != separator) && (*first == '+')) ++first;
+  ViInt32 opc{};
+  auto result = std::from_chars(first, separator, opc);
+  if ((separator == end) || (result.ec != std::errc{}) ||
+      (result.ptr != separator) || (opc != 1)) {
+    return VI_ERROR_INV_RESPONSE;
+  }
+  return ParseErrorResponse(separator + 1, std::size_t(end - separator - 1),
+                            errorCode, description);
+}
+
+}  // namespace Scpi
+
+#endif  // IVI_SCPI_H
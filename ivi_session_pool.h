@@ -0,0 +1,227 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef IVI_SESSION_POOL_H
+#define IVI_SESSION_POOL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "IviVisaType.h"
+#include "visa.h"
+
+// Keeps instrument sessions (CAgSsa, CAgXSAn, ...) open between test runs and
+// hands them out as leases keyed by resource string and options. Handing out
+// an open session costs a status byte read (CheckConnection()) instead of a
+// full *_InitWithOptions with identification query and reset; only sessions
+// that fail the check, or are requested with different options, are
+// reconnected. Instrument provides:
+//   ViStatus Connect(const std::string &, const OptionsType &);
+//   void Close();
+//   bool IsOpen() const;
+//   ViStatus CheckConnection();
+// The pool must outlive every lease taken from it.
+template <typename Instrument, typename OptionsType>
+class CIviSessionPool {
+  struct CEntry {
+    std::string Resource{};
+    OptionsType Options{};
+    std::unique_ptr<Instrument> Instance{};
+    bool IsLeased{};
+  };
+
+ public:
+  struct CRequest {
+    std::string Resource{};
+    OptionsType Options{};
+  };
+  struct CStatistics {
+    std::uint64_t Connects{};
+    std::uint64_t Reuses{};
+    std::uint64_t Reconnects{};
+  };
+  class CLease {
+    CIviSessionPool *m_Pool{};
+    CEntry *m_Entry{};
+
+    friend class CIviSessionPool;
+    CLease(CIviSessionPool &pool, CEntry &entry) noexcept
+        : m_Pool{&pool}, m_Entry{&entry} {}
+
+   public:
+    CLease() = default;
+    ~CLease() { Release(); }
+    CLease(const CLease &) = delete;
+    CLease(CLease &&other) noexcept
+        : m_Pool{std::exchange(other.m_Pool, nullptr)},
+          m_Entry{std::exchange(other.m_Entry, nullptr)} {}
+    CLease &operator=(const CLease &) = delete;
+    CLease &operator=(CLease &&other) noexcept {
+      if (this != &other) {
+        Release();
+        m_Pool = std::exchange(other.m_Pool, nullptr);
+        m_Entry = std::exchange(other.m_Entry, nullptr);
+      }
+      return *this;
+    }
+    // Hands the session back to the pool, it stays open.
+    void Release() noexcept {
+      if (m_Entry == nullptr) return;
+      m_Pool->Return(*m_Entry);
+      m_Pool = nullptr;
+      m_Entry = nullptr;
+    }
+    explicit operator bool() const noexcept { return (m_Entry != nullptr); }
+    Instrument &operator*() const noexcept { return *m_Entry->Instance; }
+    Instrument *operator->() const noexcept {
+      return m_Entry->Instance.get();
+    }
+  };
+
+ private:
+  std::mutex m_Mutex{};
+  std::vector<std::unique_ptr<CEntry>> m_Entries{};
+  CStatistics m_Statistics{};
+
+  void Return(CEntry &entry) noexcept {
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    entry.IsLeased = false;
+  }
+  // Finds the idle entry of the resource (or adds one) and marks it leased,
+  // so it can be connected without holding the lock.
+  CEntry *Reserve(const std::string &resource) {
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    for (auto &entry : m_Entries) {
+      if (entry->Resource != resource) continue;
+      if (entry->IsLeased) return nullptr;
+      entry->IsLeased = true;
+      return entry.get();
+    }
+    auto entry = std::make_unique<CEntry>();
+    entry->Resource = resource;
+    entry->Instance = std::make_unique<Instrument>();
+    entry->IsLeased = true;
+    m_Entries.push_back(std::move(entry));
+    return m_Entries.back().get();
+  }
+  void Count(std::uint64_t CStatistics::*counter) noexcept {
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    ++(m_Statistics.*counter);
+  }
+
+ public:
+  CIviSessionPool() = default;
+  ~CIviSessionPool() { Close(); }
+  CIviSessionPool(const CIviSessionPool &) = delete;
+  CIviSessionPool(CIviSessionPool &&) = delete;
+  CIviSessionPool &operator=(const CIviSessionPool &) = delete;
+  CIviSessionPool &operator=(CIviSessionPool &&) = delete;
+
+  // Returns VI_ERROR_RSRC_LOCKED while the resource is leased elsewhere.
+  ViStatus Acquire(const std::string &resource, const OptionsType &options,
+                   CLease &lease) {
+    CEntry *entry{Reserve(resource)};
+    if (entry == nullptr) return VI_ERROR_RSRC_LOCKED;
+    CLease reserved{*this, *entry};
+    Instrument &instance{*entry->Instance};
+    if (instance.IsOpen()) {
+      if ((entry->Options == options) &&
+          (instance.CheckConnection() == VI_SUCCESS)) {
+        Count(&CStatistics::Reuses);
+        lease = std::move(reserved);
+        return VI_SUCCESS;
+      }
+      instance.Close();
+      Count(&CStatistics::Reconnects);
+    } else {
+      Count(&CStatistics::Connects);
+    }
+    auto status = instance.Connect(resource, options);
+    if (status < VI_SUCCESS) {
+      instance.Close();
+      return status;
+    }
+    entry->Options = options;
+    lease = std::move(reserved);
+    return status;
+  }
+  // Brings up every requested session at once, each on its own thread, so a
+  // rack takes about as long as its slowest instrument. Repeated requests
+  // are connected once; the same resource with different options fails
+  // with VI_ERROR_INV_SETUP before anything is connected. Returns the first
+  // failure in request order; the sessions stay in the pool unleased.
+  ViStatus Connect(const std::vector<CRequest> &requests) {
+    std::vector<const CRequest *> unique{};
+    unique.reserve(requests.size());
+    for (const auto &request : requests) {
+      auto found = std::find_if(unique.begin(), unique.end(),
+                                [&request](const CRequest *other) {
+                                  return other->Resource == request.Resource;
+                                });
+      if (found == unique.end()) {
+        unique.push_back(&request);
+      } else if (!((*found)->Options == request.Options)) {
+        return VI_ERROR_INV_SETUP;
+      }
+    }
+    std::vector<std::future<ViStatus>> results{};
+    results.reserve(unique.size());
+    for (const auto *request : unique) {
+      results.push_back(std::async(std::launch::async, [this, request] {
+        CLease lease{};
+        return Acquire(request->Resource, request->Options, lease);
+      }));
+    }
+    ViStatus status{VI_SUCCESS};
+    for (auto &result : results) {
+      const auto resultStatus = result.get();
+      if ((status == VI_SUCCESS) && (resultStatus < VI_SUCCESS)) {
+        status = resultStatus;
+      }
+    }
+    return status;
+  }
+  // Closes the sessions not leased at the moment.
+  void Close() noexcept {
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    for (auto &entry : m_Entries) {
+      if (!entry->IsLeased && entry->Instance->IsOpen()) {
+        entry->Instance->Close();
+      }
+    }
+  }
+  CStatistics GetStatistics() noexcept {
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    return m_Statistics;
+  }
+};
+
+#endif  // IVI_SESSION_POOL_H
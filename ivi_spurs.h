@@ -0,0 +1,382 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef IVI_SPURS_H
+#define IVI_SPURS_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// IVI_SPURS_DETAIL_* are private to this header and undefined at its end.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define IVI_SPURS_DETAIL_SIMD
+#elif defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define IVI_SPURS_DETAIL_SIMD
+#define IVI_SPURS_DETAIL_SSE2
+#endif
+
+#include "IviVisaType.h"
+#include "visa.h"
+
+namespace Spurs {
+
+// Spurs stored column-wise, so the limit kernels below stream through
+// contiguous doubles instead of striding over interleaved records.
+struct CSpursColumns {
+  std::vector<ViReal64> Frequency{};
+  std::vector<ViReal64> Amplitude{};
+  std::vector<ViReal64> Limit{};
+
+  std::size_t size() const noexcept { return Frequency.size(); }
+  bool empty() const noexcept { return Frequency.empty(); }
+  void clear() noexcept {
+    Frequency.clear();
+    Amplitude.clear();
+    Limit.clear();
+  }
+  void reserve(std::size_t size) {
+    Frequency.reserve(size);
+    Amplitude.reserve(size);
+    Limit.reserve(size);
+  }
+  // Appends records having Frequency, Amplitude and Limit fields. Throws
+  // std::bad_alloc and then leaves the columns unchanged.
+  template <typename Record>
+  void Append(const Record *records, std::size_t recordsNum) {
+    const auto first = size();
+    const auto capacity = std::min(
+        {Frequency.capacity(), Amplitude.capacity(), Limit.capacity()});
+    if (first + recordsNum > capacity) {
+      reserve(std::max(first + recordsNum, 2 * first));
+    }
+    Frequency.resize(first + recordsNum);
+    Amplitude.resize(first + recordsNum);
+    Limit.resize(first + recordsNum);
+    for (std::size_t idx{}; idx < recordsNum; ++idx) {
+      Frequency[first + idx] = records[idx].Frequency;
+      Amplitude[first + idx] = records[idx].Amplitude;
+      Limit[first + idx] = records[idx].Limit;
+    }
+  }
+};
+
+struct CWorstMargin {
+  ViReal64 Margin{std::numeric_limits<ViReal64>::infinity()};
+  std::size_t Index{};
+};
+
+namespace Detail {
+
+#if defined(__AVX2__)
+struct CVector {
+  using Type = __m256d;
+  inline static constexpr std::size_t Lanes{4};
+  static Type Load(const ViReal64 *data) noexcept {
+    return _mm256_loadu_pd(data);
+  }
+  static void Store(ViReal64 *data, Type value) noexcept {
+    _mm256_storeu_pd(data, value);
+  }
+  static Type Set(ViReal64 value) noexcept { return _mm256_set1_pd(value); }
+  // {0, 1, 2, 3}
+  static Type Iota() noexcept { return _mm256_set_pd(3.0, 2.0, 1.0, 0.0); }
+  static Type Add(Type lhs, Type rhs) noexcept {
+    return _mm256_add_pd(lhs, rhs);
+  }
+  static Type Sub(Type lhs, Type rhs) noexcept {
+    return _mm256_sub_pd(lhs, rhs);
+  }
+  static Type Less(Type lhs, Type rhs) noexcept {
+    return _mm256_cmp_pd(lhs, rhs, _CMP_LT_OQ);
+  }
+  // mask ? lhs : rhs per lane
+  static Type Select(Type mask, Type lhs, Type rhs) noexcept {
+    return _mm256_blendv_pd(rhs, lhs, mask);
+  }
+  static int LessEqual(Type lhs, Type rhs) noexcept {
+    return _mm256_movemask_pd(_mm256_cmp_pd(lhs, rhs, _CMP_LE_OQ));
+  }
+  static int IsNaN(Type value) noexcept {
+    return _mm256_movemask_pd(_mm256_cmp_pd(value, value, _CMP_UNORD_Q));
+  }
+};
+#elif defined(IVI_SPURS_DETAIL_SSE2)
+struct CVector {
+  using Type = __m128d;
+  inline static constexpr std::size_t Lanes{2};
+  static Type Load(const ViReal64 *data) noexcept { return _mm_loadu_pd(data); }
+  static void Store(ViReal64 *data, Type value) noexcept {
+    _mm_storeu_pd(data, value);
+  }
+  static Type Set(ViReal64 value) noexcept { return _mm_set1_pd(value); }
+  // {0, 1}
+  static Type Iota() noexcept { return _mm_set_pd(1.0, 0.0); }
+  static Type Add(Type lhs, Type rhs) noexcept { return _mm_add_pd(lhs, rhs); }
+  static Type Sub(Type lhs, Type rhs) noexcept { return _mm_sub_pd(lhs, rhs); }
+  static Type Less(Type lhs, Type rhs) noexcept {
+    return _mm_cmplt_pd(lhs, rhs);
+  }
+  // mask ? lhs : rhs per lane
+  static Type Select(Type mask, Type lhs, Type rhs) noexcept {
+    return _mm_or_pd(_mm_and_pd(mask, lhs), _mm_andnot_pd(mask, rhs));
+  }
+  static int LessEqual(Type lhs, Type rhs) noexcept {
+    return _mm_movemask_pd(_mm_cmple_pd(lhs, rhs));
+  }
+  static int IsNaN(Type value) noexcept {
+    return _mm_movemask_pd(_mm_cmpunord_pd(value, value));
+  }
+};
+#endif
+
+}  // namespace Detail
+
+// margin[i] = limit[i] - amplitude[i]; a negative margin is a violation.
+inline void ComputeMargin(const ViReal64 *limit, const ViReal64 *amplitude,
+                          ViReal64 *margin, std::size_t size) noexcept {
+  std::size_t idx{};
+#if defined(IVI_SPURS_DETAIL_SIMD)
+  using Detail::CVector;
+  for (; idx + CVector::Lanes <= size; idx += CVector::Lanes) {
+    CVector::Store(margin + idx, CVector::Sub(CVector::Load(limit + idx),
+                                              CVector::Load(amplitude + idx)));
+  }
+#endif
+  for (; idx < size; ++idx) margin[idx] = limit[idx] - amplitude[idx];
+}
+
+// Smallest margin and the first spur having it, in a single pass. A NaN
+// margin counts as the worst one (it fails ComputePassMask too), so the
+// first NaN wins. An empty input gives an infinite margin at index 0.
+inline CWorstMargin FindWorstMargin(const ViReal64 *limit,
+                                    const ViReal64 *amplitude,
+                                    std::size_t size) noexcept {
+  CWorstMargin worst{};
+  std::size_t idx{};
+#if defined(IVI_SPURS_DETAIL_SIMD)
+  using Detail::CVector;
+  if (size >= CVector::Lanes) {
+    // Every lane keeps its own minimum and the index it was first seen at.
+    auto minimum = CVector::Set(worst.Margin);
+    auto minimumIndex = CVector::Set(0.0);
+    auto index = CVector::Iota();
+    const auto step = CVector::Set(ViReal64(CVector::Lanes));
+    for (; idx + CVector::Lanes <= size; idx += CVector::Lanes) {
+      const auto margin = CVector::Sub(CVector::Load(limit + idx),
+                                       CVector::Load(amplitude + idx));
+      if (const int isNaN{CVector::IsNaN(margin)}; isNaN != 0) {
+        std::size_t lane{};
+        while (((isNaN >> lane) & 1) == 0) ++lane;
+        return CWorstMargin{limit[idx + lane] - amplitude[idx + lane],
+                            idx + lane};
+      }
+      const auto isLess = CVector::Less(margin, minimum);
+      minimum = CVector::Select(isLess, margin, minimum);
+      minimumIndex = CVector::Select(isLess, index, minimumIndex);
+      index = CVector::Add(index, step);
+    }
+    std::array<ViReal64, CVector::Lanes> lanes{};
+    std::array<ViReal64, CVector::Lanes> lanesIndex{};
+    CVector::Store(lanes.data(), minimum);
+    CVector::Store(lanesIndex.data(), minimumIndex);
+    for (std::size_t lane{}; lane < CVector::Lanes; ++lane) {
+      const auto laneIndex = std::size_t(lanesIndex[lane]);
+      if ((lanes[lane] < worst.Margin) ||
+          ((lanes[lane] == worst.Margin) && (laneIndex < worst.Index))) {
+        worst.Margin = lanes[lane];
+        worst.Index = laneIndex;
+      }
+    }
+  }
+#endif
+  for (; idx < size; ++idx) {
+    const auto margin = limit[idx] - amplitude[idx];
+    if (std::isnan(margin)) return CWorstMargin{margin, idx};
+    if (margin < worst.Margin) {
+      worst.Margin = margin;
+      worst.Index = idx;
+    }
+  }
+  return worst;
+}
+
+// mask[i] = 1 if amplitude[i] <= limit[i], 0 otherwise (NaN fails).
+// Returns the number of failed spurs.
+inline std::size_t ComputePassMask(const ViReal64 *limit,
+                                   const ViReal64 *amplitude,
+                                   std::uint8_t *mask,
+                                   std::size_t size) noexcept {
+  std::size_t failuresNum{};
+  std::size_t idx{};
+#if defined(IVI_SPURS_DETAIL_SIMD)
+  using Detail::CVector;
+  for (; idx + CVector::Lanes <= size; idx += CVector::Lanes) {
+    const int passed{CVector::LessEqual(CVector::Load(amplitude + idx),
+                                        CVector::Load(limit + idx))};
+    for (std::size_t lane{}; lane < CVector::Lanes; ++lane) {
+      const std::uint8_t isPassed((passed >> lane) & 1);
+      mask[idx + lane] = isPassed;
+      failuresNum += isPassed ^ 1U;
+    }
+  }
+#endif
+  for (; idx < size; ++idx) {
+    const std::uint8_t isPassed{amplitude[idx] <= limit[idx]};
+    mask[idx] = isPassed;
+    failuresNum += isPassed ^ 1U;
+  }
+  return failuresNum;
+}
+
+inline void ComputeMargin(const CSpursColumns &spurs,
+                          std::vector<ViReal64> &margin) {
+  margin.resize(spurs.size());
+  ComputeMargin(spurs.Limit.data(), spurs.Amplitude.data(), margin.data(),
+                spurs.size());
+}
+
+inline CWorstMargin FindWorstMargin(const CSpursColumns &spurs) noexcept {
+  return FindWorstMargin(spurs.Limit.data(), spurs.Amplitude.data(),
+                         spurs.size());
+}
+
+inline std::size_t ComputePassMask(const CSpursColumns &spurs,
+                                   std::vector<std::uint8_t> &mask) {
+  mask.resize(spurs.size());
+  return ComputePassMask(spurs.Limit.data(), spurs.Amplitude.data(),
+                         mask.data(), spurs.size());
+}
+
+enum class SpurEvent { Appeared, Disappeared, Moved, AmplitudeChanged };
+
+struct CSpurChange {
+  SpurEvent Event{};
+  ViReal64 Frequency{};
+  ViReal64 Amplitude{};
+  ViReal64 PreviousFrequency{};
+  ViReal64 PreviousAmplitude{};
+};
+
+// Follows spurs from sweep to sweep. Both sweeps are kept sorted by
+// frequency and matched in one linear merge: spurs closer than the frequency
+// tolerance are the same spur. Only the differences are reported, as
+// CSpurChange events passed to sink: a matched spur is Moved when its
+// frequency shifts by more than the movement threshold (so measurement
+// jitter stays quiet) and AmplitudeChanged when its amplitude shifts by more
+// than the amplitude tolerance.
+class CSpurTracker {
+  struct CSpur {
+    ViReal64 Frequency{};
+    ViReal64 Amplitude{};
+  };
+  std::vector<CSpur> m_Spurs{};
+  std::vector<CSpur> m_Next{};
+  ViReal64 m_FrequencyTolerance{};
+  ViReal64 m_AmplitudeTolerance{};
+  ViReal64 m_MovementThreshold{};
+
+ public:
+  CSpurTracker(ViReal64 frequencyTolerance, ViReal64 amplitudeTolerance,
+               ViReal64 movementThreshold)
+      : m_FrequencyTolerance{frequencyTolerance},
+        m_AmplitudeTolerance{amplitudeTolerance},
+        m_MovementThreshold{movementThreshold} {}
+  // Records need Frequency and Amplitude fields. Fails with VI_ERROR_ALLOC,
+  // leaving the tracked state untouched, when the sweep does not fit.
+  template <typename Record, typename Sink>
+  ViStatus Update(const Record *records, std::size_t recordsNum,
+                  Sink &&sink) noexcept {
+    try {
+      m_Next.resize(recordsNum);
+    } catch (...) {
+      return VI_ERROR_ALLOC;
+    }
+    for (std::size_t idx{}; idx < recordsNum; ++idx) {
+      m_Next[idx] = CSpur{records[idx].Frequency, records[idx].Amplitude};
+    }
+    std::sort(m_Next.begin(), m_Next.end(),
+              [](const CSpur &lhs, const CSpur &rhs) {
+                return lhs.Frequency < rhs.Frequency;
+              });
+    auto previous = m_Spurs.cbegin();
+    auto next = m_Next.cbegin();
+    while ((previous != m_Spurs.cend()) || (next != m_Next.cend())) {
+      if (next == m_Next.cend() ||
+          ((previous != m_Spurs.cend()) &&
+           (previous->Frequency < next->Frequency - m_FrequencyTolerance))) {
+        sink(CSpurChange{SpurEvent::Disappeared, previous->Frequency,
+                         previous->Amplitude, previous->Frequency,
+                         previous->Amplitude});
+        ++previous;
+      } else if ((previous == m_Spurs.cend()) ||
+                 (next->Frequency < previous->Frequency -
+                                        m_FrequencyTolerance)) {
+        sink(CSpurChange{SpurEvent::Appeared, next->Frequency, next->Amplitude,
+                         next->Frequency, next->Amplitude});
+        ++next;
+      } else {
+        const CSpurChange change{SpurEvent::Moved, next->Frequency,
+                                 next->Amplitude, previous->Frequency,
+                                 previous->Amplitude};
+        if (std::abs(next->Frequency - previous->Frequency) >
+            m_MovementThreshold) {
+          sink(change);
+        }
+        if (std::abs(next->Amplitude - previous->Amplitude) >
+            m_AmplitudeTolerance) {
+          auto amplitudeChange = change;
+          amplitudeChange.Event = SpurEvent::AmplitudeChanged;
+          sink(amplitudeChange);
+        }
+        ++previous;
+        ++next;
+      }
+    }
+    m_Spurs.swap(m_Next);
+    return VI_SUCCESS;
+  }
+  template <typename Records, typename Sink>
+  ViStatus Update(const Records &records, Sink &&sink) noexcept {
+    return Update(records.data(), records.size(), std::forward<Sink>(sink));
+  }
+  void Reset() noexcept { m_Spurs.clear(); }
+  std::size_t size() const noexcept { return m_Spurs.size(); }
+};
+
+}  // namespace Spurs
+
+#undef IVI_SPURS_DETAIL_SIMD
+#undef IVI_SPURS_DETAIL_SSE2
+
+#endif  // IVI_SPURS_H
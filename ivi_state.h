@@ -0,0 +1,219 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef IVI_STATE_H
+#define IVI_STATE_H
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "IviVisaType.h"
+#include "visa.h"
+
+#include "ivi_deferred_errors.h"
+#include "ivi_deferred_execution.h"
+#include "ivi_inner_session.h"
+#include "ivi_scpi.h"
+
+// Captures, stores and recalls every setting the wrapper manages. Io
+// provides, besides the raw Write and Read of CIviOperation:
+//   static void Invalidate(CIviInnerSession &);  // wrapper and driver caches
+//   template <typename Type>  // uncached driver read
+//   static ViStatus GetAttribute(CIviInnerSession &, ViConstString, ViAttr,
+//                                Type &);
+//   template <typename Type>  // cached driver write
+//   static ViStatus SetAttribute(CIviInnerSession &, ViConstString, ViAttr,
+//                                Type);
+//   static ViStatus CaptureSettings(CIviInnerSession &,
+//                                   CIviAttributeCache::CSnapshot &);
+// CaptureSettings reads the managed set back from the instrument, typically
+// with CaptureValues and the instrument's own table queries.
+template <typename Io>
+class CIviState {
+ public:
+  // Appends what the instrument currently holds for the descriptors.
+  template <typename... Descriptors>
+  static ViStatus CaptureValues(
+      CIviInnerSession &session,
+      CIviAttributeCache::CSnapshot &settings) noexcept {
+    ViStatus status{VI_SUCCESS};
+    auto read = [&status, &session, &settings](auto descriptor) {
+      using Descriptor = decltype(descriptor);
+      typename Descriptor::RawType raw{};
+      status =
+          Io::GetAttribute(session, Descriptor::RepCap, Descriptor::Id, raw);
+      if (status != VI_SUCCESS) return false;
+      try {
+        settings.Values.push_back(CIviAttributeCache::CValue{
+            (Descriptor::RepCap == nullptr) ? std::string{}
+                                            : std::string{Descriptor::RepCap},
+            Descriptor::Id, raw});
+      } catch (...) {
+        status = VI_ERROR_ALLOC;
+        return false;
+      }
+      return true;
+    };
+    (read(Descriptors{}) && ...);
+    return status;
+  }
+  // Runs sequence (ViStatus()) with the Configure* calls recorded into
+  // batch instead of being sent. Only descriptors naming a SCPI header can
+  // be recorded; any other driver call fails with VI_ERROR_NSUP_OPER. The
+  // sequence owns the session.
+  template <typename Sequence>
+  static ViStatus Record(CIviInnerSession &session, Scpi::CScpiBatch &batch,
+                         Sequence &&sequence) noexcept {
+    session.Recording.store(&batch, std::memory_order_relaxed);
+    ViStatus status{};
+    try {
+      status = sequence();
+    } catch (...) {
+      status = VI_ERROR_ALLOC;
+    }
+    session.Recording.store(nullptr, std::memory_order_relaxed);
+    return status;
+  }
+  // Sends the whole batch as one program message and waits for it with a
+  // single *OPC? and SYST:ERR? check. When an error is queued, the rest of
+  // the queue is drained too, so errors holds all of them (empty if none).
+  // A batch resetting the instrument (*RST) takes the transfer format back
+  // to ASCII.
+  static ViStatus Execute(CIviInnerSession &session,
+                          const Scpi::CScpiBatch &batch,
+                          std::vector<CIviDeferredError> &errors) noexcept {
+    errors.clear();
+    Io::Invalidate(session);
+    if (std::string_view{batch.Message()}.find("*RST") !=
+        std::string_view::npos) {
+      session.Revert();
+    }
+    auto status = Io::Write(session, batch.Message());
+    if (status != VI_SUCCESS) return status;
+    std::array<ViChar, 256> response{};
+    std::size_t responseSize{};
+    status = Scpi::ReadResponse(
+        [&session](ViChar *buf, ViInt64 size, ViInt64 *retSize) {
+          return Io::Read(session, buf, size, retSize);
+        },
+        response, responseSize);
+    if (status != VI_SUCCESS) return status;
+    ViInt32 errorCode{};
+    std::string_view description{};
+    status = Scpi::ParseBatchResponse(response.data(), responseSize,
+                                      errorCode, description);
+    if ((status != VI_SUCCESS) || (errorCode == 0)) return status;
+    try {
+      errors.push_back(CIviDeferredError{errorCode, std::string{description}});
+      return CIviDeferredExecution<Io>::Drain(session, errors);
+    } catch (...) {
+      return VI_ERROR_ALLOC;
+    }
+  }
+  // As above, errorCode is the first queued instrument error (0 if none).
+  static ViStatus Execute(CIviInnerSession &session,
+                          const Scpi::CScpiBatch &batch,
+                          ViInt32 &errorCode) noexcept {
+    std::vector<CIviDeferredError> errors{};
+    auto status = Execute(session, batch, errors);
+    errorCode = errors.empty() ? 0 : errors.front().Code;
+    return status;
+  }
+  // Reads every managed setting back from the instrument.
+  static ViStatus Capture(CIviInnerSession &session,
+                          CIviStateSnapshot &snapshot) noexcept {
+    CIviAttributeCache::CSnapshot settings{};
+    auto status = Io::CaptureSettings(session, settings);
+    if (status != VI_SUCCESS) return status;
+    snapshot.Settings = std::move(settings);
+    snapshot.Register.reset();
+    return VI_SUCCESS;
+  }
+  // Captures the state and stores it in instrument state register number
+  // too (*SAV), so it can be recalled with a single command.
+  static ViStatus Save(CIviInnerSession &session, CIviStateSnapshot &snapshot,
+                       ViInt32 number, ViInt32 &errorCode) noexcept {
+    auto status = Capture(session, snapshot);
+    if (status != VI_SUCCESS) return status;
+    try {
+      Scpi::CScpiBatch batch{};
+      batch.Add("*SAV", number);
+      status = Execute(session, batch, errorCode);
+      session.AttributeCache.Restore(snapshot.Settings);
+    } catch (...) {
+      return VI_ERROR_ALLOC;
+    }
+    if ((status == VI_SUCCESS) && (errorCode == 0)) snapshot.Register = number;
+    return status;
+  }
+  // A snapshot bound to a state register is recalled with one *RCL,
+  // otherwise only the settings differing from the cache are sent.
+  static ViStatus Recall(CIviInnerSession &session,
+                         const CIviStateSnapshot &snapshot,
+                         ViInt32 &errorCode) noexcept {
+    errorCode = 0;
+    if (!snapshot.Register) return Apply(session, snapshot.Settings);
+    try {
+      Scpi::CScpiBatch batch{};
+      batch.Add("*RCL", *snapshot.Register);
+      auto status = Execute(session, batch, errorCode);
+      if ((status == VI_SUCCESS) && (errorCode == 0)) {
+        session.AttributeCache.Restore(snapshot.Settings);
+      }
+      return status;
+    } catch (...) {
+      return ViStatus{VI_ERROR_ALLOC};
+    }
+  }
+  // Brings the instrument to the settings. Values and tables the attribute
+  // cache already holds are skipped, so only the differences are sent.
+  static ViStatus Apply(
+      CIviInnerSession &session,
+      const CIviAttributeCache::CSnapshot &settings) noexcept {
+    for (const auto &value : settings.Values) {
+      const ViConstString repCap{value.RepCap.empty() ? nullptr
+                                                      : value.RepCap.c_str()};
+      auto status = std::visit(
+          [&session, &value, repCap](auto item) {
+            return Io::SetAttribute(session, repCap, value.Id, item);
+          },
+          value.Value);
+      if (status != VI_SUCCESS) return status;
+    }
+    for (const auto &table : settings.Tables) {
+      auto status = table.second.Apply(session, table.first,
+                                       table.second.Function,
+                                       table.second.Bytes);
+      if (status != VI_SUCCESS) return status;
+    }
+    return VI_SUCCESS;
+  }
+};
+
+#endif  // IVI_STATE_H
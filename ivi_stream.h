@@ -0,0 +1,178 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef IVI_STREAM_H
+#define IVI_STREAM_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "IviVisaType.h"
+#include "visa.h"
+
+// Lock-free single-producer/single-consumer ring of preallocated slots.
+// Values are swapped in and out rather than copied, so element types owning
+// storage (e.g. std::vector) keep cycling the same buffers and the steady
+// state does not allocate.
+template <typename Type>
+class CIviSpscRing {
+  inline static constexpr std::size_t CacheLineSize{64};
+  std::vector<Type> m_Slots{};
+  std::size_t m_Mask{};
+  alignas(CacheLineSize) std::atomic<std::size_t> m_Head{};
+  alignas(CacheLineSize) std::atomic<std::size_t> m_Tail{};
+
+  static std::size_t RoundUpCapacity(std::size_t capacity) noexcept {
+    std::size_t rounded{1};
+    while (rounded < capacity) rounded <<= 1;
+    return rounded;
+  }
+
+ public:
+  // Capacity is rounded up to a power of two.
+  explicit CIviSpscRing(std::size_t capacity)
+      : m_Slots(RoundUpCapacity(capacity)), m_Mask{m_Slots.size() - 1} {}
+  CIviSpscRing(const CIviSpscRing &) = delete;
+  CIviSpscRing &operator=(const CIviSpscRing &) = delete;
+  // Producer side. On success value receives the previous slot content.
+  bool TryPush(Type &value) noexcept {
+    const auto tail = m_Tail.load(std::memory_order_relaxed);
+    if (tail - m_Head.load(std::memory_order_acquire) == m_Slots.size()) {
+      return false;
+    }
+    std::swap(m_Slots[tail & m_Mask], value);
+    m_Tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+  // Consumer side. On success the slot receives the previous value content.
+  bool TryPop(Type &value) noexcept {
+    const auto head = m_Head.load(std::memory_order_relaxed);
+    if (head == m_Tail.load(std::memory_order_acquire)) return false;
+    std::swap(m_Slots[head & m_Mask], value);
+    m_Head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+  std::size_t Size() const noexcept {
+    return m_Tail.load(std::memory_order_acquire) -
+           m_Head.load(std::memory_order_acquire);
+  }
+  std::size_t Capacity() const noexcept { return m_Slots.size(); }
+};
+
+// Runs an acquisition loop on a dedicated I/O thread and hands every
+// acquired frame to the consumer through a CIviSpscRing. When the consumer
+// falls behind, new frames are dropped (and counted) instead of stalling the
+// instrument. Acquire is ViStatus(Frame &), it must overwrite the frame it is
+// given and owns the session while the stream runs: nothing else may use the
+// same instrument until Stop(). Failed acquisitions are retried with an
+// exponential backoff; after errorsMax failures in a row the stream stops by
+// itself (IsRunning() turns false, GetCounters() has the last error).
+template <typename Frame>
+class CIviStream {
+ public:
+  struct CCounters {
+    std::uint64_t Frames{};
+    std::uint64_t Overflows{};
+    std::uint64_t Errors{};
+    ViStatus LastError{};
+  };
+
+ private:
+  inline static constexpr std::chrono::milliseconds BackoffMin{1};
+  inline static constexpr std::chrono::milliseconds BackoffMax{100};
+  CIviSpscRing<Frame> m_Ring;
+  std::size_t m_ErrorsMax{};
+  std::thread m_Thread{};
+  std::atomic<bool> m_IsRunning{};
+  std::atomic<std::uint64_t> m_Frames{};
+  std::atomic<std::uint64_t> m_Overflows{};
+  std::atomic<std::uint64_t> m_Errors{};
+  std::atomic<ViStatus> m_LastError{};
+
+ public:
+  explicit CIviStream(std::size_t capacity = 64, std::size_t errorsMax = 8)
+      : m_Ring{capacity}, m_ErrorsMax{std::max<std::size_t>(errorsMax, 1)} {}
+  CIviStream(const CIviStream &) = delete;
+  CIviStream &operator=(const CIviStream &) = delete;
+  ~CIviStream() { Stop(); }
+  template <typename Acquire>
+  ViStatus Start(Acquire acquire) noexcept {
+    if (m_IsRunning.exchange(true)) return VI_ERROR_IN_PROGRESS;
+    if (m_Thread.joinable()) m_Thread.join();
+    try {
+      m_Thread = std::thread{[this, acquire]() mutable {
+        Frame frame{};
+        std::size_t errorsInRow{};
+        auto backoff = BackoffMin;
+        while (m_IsRunning.load(std::memory_order_relaxed)) {
+          const ViStatus status{acquire(frame)};
+          if (status < VI_SUCCESS) {
+            m_Errors.fetch_add(1, std::memory_order_relaxed);
+            m_LastError.store(status, std::memory_order_relaxed);
+            if (++errorsInRow >= m_ErrorsMax) break;
+            std::this_thread::sleep_for(backoff);
+            backoff = std::min(backoff * 2, BackoffMax);
+            continue;
+          }
+          errorsInRow = 0;
+          backoff = BackoffMin;
+          if (m_Ring.TryPush(frame)) {
+            m_Frames.fetch_add(1, std::memory_order_relaxed);
+          } else {
+            m_Overflows.fetch_add(1, std::memory_order_relaxed);
+          }
+        }
+        m_IsRunning.store(false, std::memory_order_relaxed);
+      }};
+    } catch (...) {
+      m_IsRunning = false;
+      return VI_ERROR_ALLOC;
+    }
+    return VI_SUCCESS;
+  }
+  // Waits for the acquisition in progress to finish.
+  void Stop() noexcept {
+    m_IsRunning = false;
+    if (m_Thread.joinable()) m_Thread.join();
+  }
+  bool IsRunning() const noexcept { return m_IsRunning; }
+  // Consumer side, frame is swapped with the oldest queued frame.
+  bool TryPop(Frame &frame) noexcept { return m_Ring.TryPop(frame); }
+  std::size_t Size() const noexcept { return m_Ring.Size(); }
+  CCounters GetCounters() const noexcept {
+    return CCounters{m_Frames.load(std::memory_order_relaxed),
+                     m_Overflows.load(std::memory_order_relaxed),
+                     m_Errors.load(std::memory_order_relaxed),
+                     m_LastError.load(std::memory_order_relaxed)};
+  }
+};
+
+#endif  // IVI_STREAM_H
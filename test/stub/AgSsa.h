@@ -0,0 +1,104 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef AGSSA_STUB_H
+#define AGSSA_STUB_H
+
+// Stand-in for the AgSsa IVI-C driver header: the attributes, values and
+// functions the wrapper uses, implemented by the stub backend.
+
+#include "IviVisaType.h"
+
+#define AGSSA_ATTR_RANGE_CHECK 1050002
+#define AGSSA_ATTR_QUERY_INSTRUMENT_STATUS 1050003
+#define AGSSA_ATTR_CACHE 1050004
+#define AGSSA_ATTR_SYSTEM_IO_SESSION 1050322
+#define AGSSA_ATTR_DISPLAY_MAXIMIZE 1150001
+#define AGSSA_ATTR_DISPLAY_ACTIVE_WINDOW 1150002
+#define AGSSA_ATTR_TRIGGER_MODE 1150003
+#define AGSSA_ATTR_TRIGGER_SOPC_ENABLED 1150004
+#define AGSSA_ATTR_APPLICATION_PHASENOISE_MEASUREMENT_SPURIOUS_POWER 1150005
+#define AGSSA_ATTR_APPLICATION_PHASENOISE_ACQUISITION_CORRELATION 1150006
+#define AGSSA_ATTR_APPLICATION_PHASENOISE_ACQUISITION_SWEEP_MODE_CONTINUOUS \
+  1150007
+#define AGSSA_ATTR_APPLICATION_PHASENOISE_DISPLAY_MAXIMIZE 1150008
+#define AGSSA_ATTR_APPLICATION_PHASENOISE_FREQUENCY_BAND 1150009
+#define AGSSA_ATTR_APPLICATION_PHASENOISE_FREQUENCY_START_OFFSET 1150010
+#define AGSSA_ATTR_APPLICATION_PHASENOISE_FREQUENCY_STOP_OFFSET 1150011
+
+#define AGSSA_VAL_DISPLAY_ACTIVE_WINDOW_PN1 1
+#define AGSSA_VAL_AGILENT_SSA_FREQUENCY_BAND1 0
+#define AGSSA_VAL_FREQUENCY_BAND2 1
+#define AGSSA_VAL_FREQUENCY_BAND3 2
+#define AGSSA_VAL_FREQUENCY_BAND4 3
+#define AGSSA_VAL_FREQUENCY_BAND5 4
+#define AGSSA_VAL_FREQUENCY_BAND6 5
+#define AGSSA_VAL_FREQUENCY_BAND_LOW 6
+#define AGSSA_VAL_FREQUENCY_BAND_HIGH 7
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+ViStatus AgSsa_InitWithOptions(ViRsrc resourceName, ViBoolean idQuery,
+                               ViBoolean reset, ViConstString optionString,
+                               ViSession *vi);
+ViStatus AgSsa_close(ViSession vi);
+ViStatus AgSsa_reset(ViSession vi);
+ViStatus AgSsa_ClearError(ViSession vi);
+ViStatus AgSsa_GetError(ViSession vi, ViStatus *errorCode,
+                        ViInt32 errorDescriptionBufferSize,
+                        ViChar errorDescription[]);
+ViStatus AgSsa_InvalidateAllAttributes(ViSession vi);
+ViStatus AgSsa_GetAttributeViBoolean(ViSession vi, ViConstString repCap,
+                                     ViAttr attributeID, ViBoolean *value);
+ViStatus AgSsa_GetAttributeViInt32(ViSession vi, ViConstString repCap,
+                                   ViAttr attributeID, ViInt32 *value);
+ViStatus AgSsa_GetAttributeViReal64(ViSession vi, ViConstString repCap,
+                                    ViAttr attributeID, ViReal64 *value);
+ViStatus AgSsa_GetAttributeViSession(ViSession vi, ViConstString repCap,
+                                     ViAttr attributeID, ViSession *value);
+ViStatus AgSsa_SetAttributeViBoolean(ViSession vi, ViConstString repCap,
+                                     ViAttr attributeID, ViBoolean value);
+ViStatus AgSsa_SetAttributeViInt32(ViSession vi, ViConstString repCap,
+                                   ViAttr attributeID, ViInt32 value);
+ViStatus AgSsa_SetAttributeViReal64(ViSession vi, ViConstString repCap,
+                                    ViAttr attributeID, ViReal64 value);
+ViStatus AgSsa_SystemWrite(ViSession vi, ViConstString command);
+ViStatus AgSsa_SystemWriteString(ViSession vi, ViConstString command);
+ViStatus AgSsa_SystemWaitForOperationComplete(ViSession vi,
+                                              ViInt32 maxTimeMilliseconds);
+ViStatus AgSsa_viRead(ViSession vi, ViInt64 bufferSize, ViChar buffer[],
+                      ViInt64 *actualSize);
+ViStatus AgSsa_ApplicationPhaseNoiseMeasurementsInitiate(ViSession vi);
+ViStatus AgSsa_ApplicationPhaseNoiseMeasurementsAbort(ViSession vi);
+ViStatus AgSsa_ApplicationPhaseNoiseMeasurementsGet_CarrierData(
+    ViSession vi, ViInt32 bufferSize, ViReal64 buffer[], ViInt32 *actualSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // AGSSA_STUB_H
@@ -0,0 +1,129 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef AGXSAN_STUB_H
+#define AGXSAN_STUB_H
+
+// Stand-in for the AgXSAn IVI-C driver header: the attributes, values and
+// functions the wrapper uses, implemented by the stub backend.
+
+#include "IviVisaType.h"
+
+#define AGXSAN_ATTR_RANGE_CHECK 1050002
+#define AGXSAN_ATTR_QUERY_INSTRUMENT_STATUS 1050003
+#define AGXSAN_ATTR_CACHE 1050004
+#define AGXSAN_ATTR_SYSTEM_IO_SESSION 1050322
+#define AGXSAN_ATTR_ACQUISITION_CONTINUOUS_SWEEP_MODE_ENABLED 1250001
+#define AGXSAN_ATTR_ATTENUATION 1250002
+#define AGXSAN_ATTR_DISPLAY_FULL_SCREEN_ENABLED 1250003
+#define AGXSAN_ATTR_INPUT_RF_CORRECTIONS_NOISE_FLOOR_EXTENSTION_ENABLED 1250004
+#define AGXSAN_ATTR_SA_SPURIOUSEMISSIONS_DISPLAY_WINDOWY_REFERENCE 1250005
+#define AGXSAN_ATTR_SA_SPURIOUSEMISSIONS_DISPLAY_WINDOWY_SCALE 1250006
+#define AGXSAN_ATTR_SA_SPURIOUSEMISSIONS_FAST_MEASUREMENT_ENABLED 1250007
+
+#define AGXSAN_VAL_MARKER_SEARCH_HIGHEST 0
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+ViStatus AgXSAn_InitWithOptions(ViRsrc resourceName, ViBoolean idQuery,
+                                ViBoolean reset, ViConstString optionString,
+                                ViSession *vi);
+ViStatus AgXSAn_close(ViSession vi);
+ViStatus AgXSAn_reset(ViSession vi);
+ViStatus AgXSAn_ClearError(ViSession vi);
+ViStatus AgXSAn_GetError(ViSession vi, ViStatus *errorCode,
+                         ViInt32 errorDescriptionBufferSize,
+                         ViChar errorDescription[]);
+ViStatus AgXSAn_InvalidateAllAttributes(ViSession vi);
+ViStatus AgXSAn_GetAttributeViBoolean(ViSession vi, ViConstString repCap,
+                                      ViAttr attributeID, ViBoolean *value);
+ViStatus AgXSAn_GetAttributeViInt32(ViSession vi, ViConstString repCap,
+                                    ViAttr attributeID, ViInt32 *value);
+ViStatus AgXSAn_GetAttributeViReal64(ViSession vi, ViConstString repCap,
+                                     ViAttr attributeID, ViReal64 *value);
+ViStatus AgXSAn_GetAttributeViSession(ViSession vi, ViConstString repCap,
+                                      ViAttr attributeID, ViSession *value);
+ViStatus AgXSAn_SetAttributeViBoolean(ViSession vi, ViConstString repCap,
+                                      ViAttr attributeID, ViBoolean value);
+ViStatus AgXSAn_SetAttributeViInt32(ViSession vi, ViConstString repCap,
+                                    ViAttr attributeID, ViInt32 value);
+ViStatus AgXSAn_SetAttributeViReal64(ViSession vi, ViConstString repCap,
+                                     ViAttr attributeID, ViReal64 value);
+ViStatus AgXSAn_SystemWriteString(ViSession vi, ViConstString command);
+ViStatus AgXSAn_SystemClearIO(ViSession vi);
+ViStatus AgXSAn_SystemWaitForOperationComplete(ViSession vi,
+                                               ViInt32 maxTimeMilliseconds);
+ViStatus AgXSAn_viRead(ViSession vi, ViInt64 bufferSize, ViChar buffer[],
+                       ViInt64 *actualSize);
+ViStatus AgXSAn_FrequencyTune(ViSession vi);
+ViStatus AgXSAn_SAMarkerQuery(ViSession vi, ViReal64 *x, ViReal64 *y);
+ViStatus AgXSAn_SAMarkerSearch(ViSession vi, ViInt32 searchType);
+ViStatus AgXSAn_SASweptSAsConfigure(ViSession vi);
+ViStatus AgXSAn_SASweptSAsInitiate(ViSession vi);
+ViStatus AgXSAn_SASpuriousEmissionsConfigure(ViSession vi);
+ViStatus AgXSAn_SASpuriousEmissionsTracesInitiate(ViSession vi);
+ViStatus AgXSAn_SASpuriousEmissionsTracesAbort(ViSession vi);
+ViStatus AgXSAn_SASpuriousEmissionsTraceFetch(ViSession vi,
+                                              ViConstString traceName,
+                                              ViInt32 bufferSize,
+                                              ViReal64 buffer[],
+                                              ViInt32 *actualSize);
+ViStatus AgXSAn_SASpuriousEmissionsTraceRead(ViSession vi,
+                                             ViConstString traceName,
+                                             ViInt32 maxTimeMilliseconds,
+                                             ViInt32 bufferSize,
+                                             ViReal64 buffer[],
+                                             ViInt32 *actualSize);
+ViStatus AgXSAn_SASpuriousEmissionsRangeTableConfigureEnabled(
+    ViSession vi, ViInt32 bufferSize, ViBoolean buffer[]);
+ViStatus AgXSAn_SASpuriousEmissionsRangeTableConfigureAttenuation(
+    ViSession vi, ViInt32 bufferSize, ViReal64 buffer[]);
+ViStatus AgXSAn_SASpuriousEmissionsRangeTableConfigurePeakThreshold(
+    ViSession vi, ViInt32 bufferSize, ViReal64 buffer[]);
+ViStatus AgXSAn_SASpuriousEmissionsRangeTableConfigureSweepPointsAutoEnabled(
+    ViSession vi, ViInt32 bufferSize, ViBoolean buffer[]);
+ViStatus AgXSAn_SASpuriousEmissionsRangeTableBandwidthConfigureResolution(
+    ViSession vi, ViInt32 bufferSize, ViReal64 buffer[]);
+ViStatus AgXSAn_SASpuriousEmissionsRangeTableQuerySweepTime(
+    ViSession vi, ViInt32 bufferSize, ViReal64 buffer[], ViInt32 *actualSize);
+ViStatus AgXSAn_SASpuriousEmissionsRangeTableStartConfigureFrequency(
+    ViSession vi, ViInt32 bufferSize, ViReal64 buffer[]);
+ViStatus AgXSAn_SASpuriousEmissionsRangeTableStopConfigureFrequency(
+    ViSession vi, ViInt32 bufferSize, ViReal64 buffer[]);
+ViStatus AgXSAn_SASpuriousEmissionsRangeTableStartConfigureAbsoluteAmplitudeLimit(
+    ViSession vi, ViInt32 bufferSize, ViReal64 buffer[]);
+ViStatus AgXSAn_SASpuriousEmissionsRangeTableStopConfigureAbsoluteAmplitudeLimit(
+    ViSession vi, ViInt32 bufferSize, ViReal64 buffer[]);
+ViStatus
+AgXSAn_SASpuriousEmissionsRangeTableStopConfigureAbsoluteAmplitudeLimitAutoEnabled(
+    ViSession vi, ViInt32 bufferSize, ViBoolean buffer[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // AGXSAN_STUB_H
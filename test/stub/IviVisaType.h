@@ -0,0 +1,74 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef IVI_VISA_TYPE_STUB_H
+#define IVI_VISA_TYPE_STUB_H
+
+// Stand-in for the IVI shared VISA type definitions, just what the wrappers
+// and the stub backend need. Status values follow the VISA specification,
+// VI_ERROR_INV_RESPONSE only has to differ from them.
+
+typedef int ViInt32;
+typedef unsigned int ViUInt32;
+typedef short ViInt16;
+typedef unsigned short ViUInt16;
+typedef long long ViInt64;
+typedef unsigned char ViByte;
+typedef char ViChar;
+typedef double ViReal64;
+typedef ViUInt16 ViBoolean;
+typedef ViInt32 ViStatus;
+typedef ViUInt32 ViObject;
+typedef ViObject ViSession;
+typedef ViObject ViEvent;
+typedef ViUInt32 ViEventType;
+typedef ViUInt32 ViAttr;
+typedef ViChar *ViString;
+typedef const ViChar *ViConstString;
+typedef ViString ViRsrc;
+
+#define VI_NULL 0
+#define VI_TRUE 1
+#define VI_FALSE 0
+
+#define VI_SUCCESS 0
+#define VI_SUCCESS_TERM_CHAR 0x3FFF0005
+#define VI_SUCCESS_MAX_CNT 0x3FFF0006
+#define VI_ERROR_SYSTEM_ERROR (-1073807360)
+#define VI_ERROR_INV_OBJECT (-1073807346)
+#define VI_ERROR_RSRC_LOCKED (-1073807345)
+#define VI_ERROR_RSRC_NFOUND (-1073807343)
+#define VI_ERROR_TMO (-1073807339)
+#define VI_ERROR_NSUP_ATTR_STATE (-1073807330)
+#define VI_ERROR_ABORT (-1073807312)
+#define VI_ERROR_IN_PROGRESS (-1073807303)
+#define VI_ERROR_INV_SETUP (-1073807302)
+#define VI_ERROR_ALLOC (-1073807300)
+#define VI_ERROR_NSUP_OPER (-1073807257)
+#define VI_ERROR_RSRC_BUSY (-1073807246)
+#define VI_ERROR_CONN_LOST (-1073807194)
+#define VI_ERROR_INV_RESPONSE (-1073807172)
+
+#endif  // IVI_VISA_TYPE_STUB_H
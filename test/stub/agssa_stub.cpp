@@ -0,0 +1,134 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "AgSsa.h"
+
+#include <algorithm>
+
+#include "stub_backend.h"
+
+extern "C" {
+
+ViStatus AgSsa_InitWithOptions(ViRsrc, ViBoolean, ViBoolean,
+                               ViConstString options, ViSession *vi) {
+  return Stub::Connect(options, vi);
+}
+
+ViStatus AgSsa_close(ViSession) { return Stub::Close(); }
+
+ViStatus AgSsa_reset(ViSession) { return Stub::Call("AgSsa_reset"); }
+
+ViStatus AgSsa_ClearError(ViSession) { return Stub::Call("AgSsa_ClearError"); }
+
+ViStatus AgSsa_GetError(ViSession, ViStatus *errorCode,
+                        ViInt32 errorDescriptionBufferSize,
+                        ViChar errorDescription[]) {
+  *errorCode = VI_SUCCESS;
+  if (errorDescriptionBufferSize > 0) errorDescription[0] = '\0';
+  return VI_SUCCESS;
+}
+
+ViStatus AgSsa_InvalidateAllAttributes(ViSession) {
+  return Stub::Invalidate();
+}
+
+ViStatus AgSsa_GetAttributeViBoolean(ViSession, ViConstString repCapIdentifier,
+                                     ViAttr attributeID, ViBoolean *value) {
+  ViReal64 stored{};
+  auto status = Stub::GetAttribute(repCapIdentifier, attributeID, stored);
+  *value = (stored != 0) ? VI_TRUE : VI_FALSE;
+  return status;
+}
+
+ViStatus AgSsa_GetAttributeViInt32(ViSession, ViConstString repCapIdentifier,
+                                   ViAttr attributeID, ViInt32 *value) {
+  ViReal64 stored{};
+  auto status = Stub::GetAttribute(repCapIdentifier, attributeID, stored);
+  *value = ViInt32(stored);
+  return status;
+}
+
+ViStatus AgSsa_GetAttributeViReal64(ViSession, ViConstString repCapIdentifier,
+                                    ViAttr attributeID, ViReal64 *value) {
+  return Stub::GetAttribute(repCapIdentifier, attributeID, *value);
+}
+
+// The I/O session is the driver session itself.
+ViStatus AgSsa_GetAttributeViSession(ViSession vi, ViConstString, ViAttr,
+                                     ViSession *value) {
+  *value = vi;
+  return VI_SUCCESS;
+}
+
+ViStatus AgSsa_SetAttributeViBoolean(ViSession, ViConstString repCapIdentifier,
+                                     ViAttr attributeID, ViBoolean value) {
+  return Stub::SetAttribute(repCapIdentifier, attributeID, value);
+}
+
+ViStatus AgSsa_SetAttributeViInt32(ViSession, ViConstString repCapIdentifier,
+                                   ViAttr attributeID, ViInt32 value) {
+  return Stub::SetAttribute(repCapIdentifier, attributeID, value);
+}
+
+ViStatus AgSsa_SetAttributeViReal64(ViSession, ViConstString repCapIdentifier,
+                                    ViAttr attributeID, ViReal64 value) {
+  return Stub::SetAttribute(repCapIdentifier, attributeID, value);
+}
+
+ViStatus AgSsa_SystemWrite(ViSession, ViConstString command) {
+  return Stub::Write(command);
+}
+
+ViStatus AgSsa_SystemWriteString(ViSession, ViConstString command) {
+  return Stub::Write(command);
+}
+
+ViStatus AgSsa_SystemWaitForOperationComplete(ViSession, ViInt32) {
+  return Stub::Call("AgSsa_SystemWaitForOperationComplete");
+}
+
+ViStatus AgSsa_viRead(ViSession, ViInt64 bufferSize, ViChar buffer[],
+                      ViInt64 *actualSize) {
+  return Stub::Read(bufferSize, buffer, actualSize);
+}
+
+ViStatus AgSsa_ApplicationPhaseNoiseMeasurementsInitiate(ViSession) {
+  return Stub::Initiate("AgSsa_ApplicationPhaseNoiseMeasurementsInitiate");
+}
+
+ViStatus AgSsa_ApplicationPhaseNoiseMeasurementsAbort(ViSession) {
+  return Stub::Call("AgSsa_ApplicationPhaseNoiseMeasurementsAbort");
+}
+
+ViStatus AgSsa_ApplicationPhaseNoiseMeasurementsGet_CarrierData(
+    ViSession, ViInt32 bufferSize, ViReal64 buffer[], ViInt32 *actualSize) {
+  constexpr ViReal64 carrier[]{1e9, -10.0};
+  const auto size = std::min<ViInt32>(bufferSize, 2);
+  std::copy_n(carrier, size, buffer);
+  *actualSize = size;
+  return VI_SUCCESS;
+}
+
+}  // extern "C"
@@ -0,0 +1,242 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "AgXSAn.h"
+
+#include <algorithm>
+
+#include "stub_backend.h"
+
+extern "C" {
+
+ViStatus AgXSAn_InitWithOptions(ViRsrc, ViBoolean, ViBoolean,
+                                ViConstString options, ViSession *vi) {
+  return Stub::Connect(options, vi);
+}
+
+ViStatus AgXSAn_close(ViSession) { return Stub::Close(); }
+
+ViStatus AgXSAn_reset(ViSession) { return Stub::Call("AgXSAn_reset"); }
+
+ViStatus AgXSAn_ClearError(ViSession) {
+  return Stub::Call("AgXSAn_ClearError");
+}
+
+ViStatus AgXSAn_GetError(ViSession, ViStatus *errorCode,
+                         ViInt32 errorDescriptionBufferSize,
+                         ViChar errorDescription[]) {
+  *errorCode = VI_SUCCESS;
+  if (errorDescriptionBufferSize > 0) errorDescription[0] = '\0';
+  return VI_SUCCESS;
+}
+
+ViStatus AgXSAn_InvalidateAllAttributes(ViSession) {
+  return Stub::Invalidate();
+}
+
+ViStatus AgXSAn_GetAttributeViBoolean(ViSession,
+                                      ViConstString repCapIdentifier,
+                                      ViAttr attributeID, ViBoolean *value) {
+  ViReal64 stored{};
+  auto status = Stub::GetAttribute(repCapIdentifier, attributeID, stored);
+  *value = (stored != 0) ? VI_TRUE : VI_FALSE;
+  return status;
+}
+
+ViStatus AgXSAn_GetAttributeViInt32(ViSession, ViConstString repCapIdentifier,
+                                    ViAttr attributeID, ViInt32 *value) {
+  ViReal64 stored{};
+  auto status = Stub::GetAttribute(repCapIdentifier, attributeID, stored);
+  *value = ViInt32(stored);
+  return status;
+}
+
+ViStatus AgXSAn_GetAttributeViReal64(ViSession,
+                                     ViConstString repCapIdentifier,
+                                     ViAttr attributeID, ViReal64 *value) {
+  return Stub::GetAttribute(repCapIdentifier, attributeID, *value);
+}
+
+// The I/O session is the driver session itself.
+ViStatus AgXSAn_GetAttributeViSession(ViSession vi, ViConstString, ViAttr,
+                                      ViSession *value) {
+  *value = vi;
+  return VI_SUCCESS;
+}
+
+ViStatus AgXSAn_SetAttributeViBoolean(ViSession,
+                                      ViConstString repCapIdentifier,
+                                      ViAttr attributeID, ViBoolean value) {
+  return Stub::SetAttribute(repCapIdentifier, attributeID, value);
+}
+
+ViStatus AgXSAn_SetAttributeViInt32(ViSession, ViConstString repCapIdentifier,
+                                    ViAttr attributeID, ViInt32 value) {
+  return Stub::SetAttribute(repCapIdentifier, attributeID, value);
+}
+
+ViStatus AgXSAn_SetAttributeViReal64(ViSession,
+                                     ViConstString repCapIdentifier,
+                                     ViAttr attributeID, ViReal64 value) {
+  return Stub::SetAttribute(repCapIdentifier, attributeID, value);
+}
+
+ViStatus AgXSAn_SystemWriteString(ViSession, ViConstString command) {
+  return Stub::Write(command);
+}
+
+ViStatus AgXSAn_SystemClearIO(ViSession) {
+  return Stub::Call("AgXSAn_SystemClearIO");
+}
+
+ViStatus AgXSAn_SystemWaitForOperationComplete(ViSession, ViInt32) {
+  return Stub::Call("AgXSAn_SystemWaitForOperationComplete");
+}
+
+ViStatus AgXSAn_viRead(ViSession, ViInt64 bufferSize, ViChar buffer[],
+                       ViInt64 *actualSize) {
+  return Stub::Read(bufferSize, buffer, actualSize);
+}
+
+ViStatus AgXSAn_FrequencyTune(ViSession) {
+  return Stub::Call("AgXSAn_FrequencyTune");
+}
+
+ViStatus AgXSAn_SAMarkerQuery(ViSession, ViReal64 *x, ViReal64 *y) {
+  *x = 0.0;
+  *y = 0.0;
+  return Stub::Call("AgXSAn_SAMarkerQuery");
+}
+
+ViStatus AgXSAn_SAMarkerSearch(ViSession, ViInt32) {
+  return Stub::Call("AgXSAn_SAMarkerSearch");
+}
+
+ViStatus AgXSAn_SASweptSAsConfigure(ViSession) {
+  return Stub::Call("AgXSAn_SASweptSAsConfigure");
+}
+
+ViStatus AgXSAn_SASweptSAsInitiate(ViSession) {
+  return Stub::Initiate("AgXSAn_SASweptSAsInitiate");
+}
+
+ViStatus AgXSAn_SASpuriousEmissionsConfigure(ViSession) {
+  return Stub::Call("AgXSAn_SASpuriousEmissionsConfigure");
+}
+
+ViStatus AgXSAn_SASpuriousEmissionsTracesInitiate(ViSession) {
+  return Stub::Initiate("AgXSAn_SASpuriousEmissionsTracesInitiate");
+}
+
+ViStatus AgXSAn_SASpuriousEmissionsTracesAbort(ViSession) {
+  return Stub::Call("AgXSAn_SASpuriousEmissionsTracesAbort");
+}
+
+ViStatus AgXSAn_SASpuriousEmissionsTraceFetch(ViSession, ViConstString,
+                                              ViInt32 bufferSize,
+                                              ViReal64 buffer[],
+                                              ViInt32 *actualSize) {
+  return Stub::FetchTrace(bufferSize, buffer, actualSize);
+}
+
+ViStatus AgXSAn_SASpuriousEmissionsTraceRead(ViSession, ViConstString,
+                                             ViInt32, ViInt32 bufferSize,
+                                             ViReal64 buffer[],
+                                             ViInt32 *actualSize) {
+  return Stub::FetchTrace(bufferSize, buffer, actualSize);
+}
+
+ViStatus AgXSAn_SASpuriousEmissionsRangeTableConfigureEnabled(ViSession,
+                                                              ViInt32,
+                                                              ViBoolean[]) {
+  return Stub::Call("AgXSAn_SASpuriousEmissionsRangeTableConfigureEnabled");
+}
+
+ViStatus AgXSAn_SASpuriousEmissionsRangeTableConfigureAttenuation(
+    ViSession, ViInt32, ViReal64[]) {
+  return Stub::Call(
+      "AgXSAn_SASpuriousEmissionsRangeTableConfigureAttenuation");
+}
+
+ViStatus AgXSAn_SASpuriousEmissionsRangeTableConfigurePeakThreshold(
+    ViSession, ViInt32, ViReal64[]) {
+  return Stub::Call(
+      "AgXSAn_SASpuriousEmissionsRangeTableConfigurePeakThreshold");
+}
+
+ViStatus AgXSAn_SASpuriousEmissionsRangeTableConfigureSweepPointsAutoEnabled(
+    ViSession, ViInt32, ViBoolean[]) {
+  return Stub::Call(
+      "AgXSAn_SASpuriousEmissionsRangeTableConfigureSweepPointsAutoEnabled");
+}
+
+ViStatus AgXSAn_SASpuriousEmissionsRangeTableBandwidthConfigureResolution(
+    ViSession, ViInt32, ViReal64[]) {
+  return Stub::Call(
+      "AgXSAn_SASpuriousEmissionsRangeTableBandwidthConfigureResolution");
+}
+
+ViStatus AgXSAn_SASpuriousEmissionsRangeTableQuerySweepTime(
+    ViSession, ViInt32 bufferSize, ViReal64 buffer[], ViInt32 *actualSize) {
+  std::fill_n(buffer, bufferSize, 0.0);
+  *actualSize = bufferSize;
+  return Stub::Call("AgXSAn_SASpuriousEmissionsRangeTableQuerySweepTime");
+}
+
+ViStatus AgXSAn_SASpuriousEmissionsRangeTableStartConfigureFrequency(
+    ViSession, ViInt32, ViReal64[]) {
+  return Stub::Call(
+      "AgXSAn_SASpuriousEmissionsRangeTableStartConfigureFrequency");
+}
+
+ViStatus AgXSAn_SASpuriousEmissionsRangeTableStopConfigureFrequency(
+    ViSession, ViInt32, ViReal64[]) {
+  return Stub::Call(
+      "AgXSAn_SASpuriousEmissionsRangeTableStopConfigureFrequency");
+}
+
+ViStatus AgXSAn_SASpuriousEmissionsRangeTableStartConfigureAbsoluteAmplitudeLimit(
+    ViSession, ViInt32, ViReal64[]) {
+  return Stub::Call(
+      "AgXSAn_SASpuriousEmissionsRangeTableStartConfigureAbsoluteAmplitudeLim"
+      "it");
+}
+
+ViStatus AgXSAn_SASpuriousEmissionsRangeTableStopConfigureAbsoluteAmplitudeLimit(
+    ViSession, ViInt32, ViReal64[]) {
+  return Stub::Call(
+      "AgXSAn_SASpuriousEmissionsRangeTableStopConfigureAbsoluteAmplitudeLimi"
+      "t");
+}
+
+ViStatus
+AgXSAn_SASpuriousEmissionsRangeTableStopConfigureAbsoluteAmplitudeLimitAutoEnabled(
+    ViSession, ViInt32, ViBoolean[]) {
+  return Stub::Call(
+      "AgXSAn_SASpuriousEmissionsRangeTableStopConfigureAbsoluteAmplitudeLimi"
+      "tAutoEnabled");
+}
+
+}  // extern "C"
@@ -0,0 +1,340 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "stub_backend.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include <thread>
+
+#include "visa.h"
+
+namespace Stub {
+
+namespace {
+
+// IVI inherent attributes, the same in every driver.
+constexpr ViAttr InherentAttributeBase{1050000};
+constexpr ViAttr SpecificAttributeBase{1150000};
+constexpr ViAttr RangeCheckAttribute{1050002};
+constexpr ViAttr QueryInstrumentStatusAttribute{1050003};
+constexpr ViAttr CacheAttribute{1050004};
+
+CBackend g_Backend{};
+
+std::string RepCapName(ViConstString repCap) {
+  return (repCap == nullptr) ? std::string{} : std::string{repCap};
+}
+
+// Reads "Name=true" or "Name=false" ahead of DriverSetup, which takes the
+// rest of the string.
+bool ParseOption(std::string_view options, std::string_view name,
+                 bool defaultValue) {
+  options = options.substr(0, options.find("DriverSetup="));
+  for (auto pos = options.find(name); pos != std::string_view::npos;
+       pos = options.find(name, pos + 1)) {
+    if ((pos != 0) && (options[pos - 1] != ' ') && (options[pos - 1] != ',')) {
+      continue;
+    }
+    const auto value = options.substr(pos + name.size());
+    if (value.substr(0, 5) == "=true") return true;
+    if (value.substr(0, 6) == "=false") return false;
+  }
+  return defaultValue;
+}
+
+bool IsInherent(ViAttr id) {
+  return (id >= InherentAttributeBase) && (id < SpecificAttributeBase);
+}
+
+bool IsEnabled(ViAttr id) {
+  auto found = g_Backend.Attributes.find({std::string{}, id});
+  return (found != g_Backend.Attributes.end()) && (found->second != 0.0);
+}
+
+// Busy waits, sleeping is far too coarse for microsecond latencies.
+void Spin(std::chrono::nanoseconds duration) {
+  if (duration <= std::chrono::nanoseconds::zero()) return;
+  const auto end = std::chrono::steady_clock::now() + duration;
+  while (std::chrono::steady_clock::now() < end) {
+  }
+}
+
+// One instrument access, plus the error query the driver adds to it. The
+// backend is released while the access takes its time, so sessions used
+// from different threads wait for their instruments in parallel.
+void Transact(std::unique_lock<std::mutex> &lock) {
+  const auto accessesNum = IsEnabled(QueryInstrumentStatusAttribute) ? 2 : 1;
+  g_Backend.Transactions += accessesNum;
+  const auto latency = g_Backend.IoLatency * accessesNum;
+  lock.unlock();
+  Spin(latency);
+  lock.lock();
+}
+
+// xorshift32, so the spurs do not depend on the standard library.
+std::uint32_t NextRandom(std::uint32_t &state) {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+}  // namespace
+
+CBackend &Backend() { return g_Backend; }
+
+void Reset() {
+  std::lock_guard<std::mutex> lock{g_Backend.Mutex};
+  g_Backend.Writes.clear();
+  g_Backend.IsWriteLogged = true;
+  g_Backend.Replies.clear();
+  g_Backend.DefaultReply.clear();
+  g_Backend.Reply.clear();
+  g_Backend.ReplyPos = 0;
+  g_Backend.ReadChunkMax = 1024;
+  g_Backend.Attributes.clear();
+  g_Backend.AttributeWrites = 0;
+  g_Backend.AttributeReads = 0;
+  g_Backend.Invalidations = 0;
+  g_Backend.InitOptions.clear();
+  g_Backend.DriverCache.clear();
+  g_Backend.Transactions = 0;
+  g_Backend.IoLatency = std::chrono::microseconds{};
+  g_Backend.ByteCost = std::chrono::nanoseconds{};
+  g_Backend.Connects = 0;
+  g_Backend.Closes = 0;
+  g_Backend.ConnectDelay = std::chrono::milliseconds{};
+  g_Backend.ConnectStatus = VI_SUCCESS;
+  g_Backend.StatusByteStatus = VI_SUCCESS;
+  g_Backend.FailFunction.clear();
+  g_Backend.FailStatus = VI_SUCCESS;
+  g_Backend.Trace.clear();
+  g_Backend.Initiates = 0;
+}
+
+std::vector<CSpur> GenerateSpurs(std::size_t spursNum, std::uint32_t seed) {
+  std::uint32_t state{seed | 1};
+  std::vector<CSpur> spurs(spursNum);
+  ViReal64 frequency{1e6};
+  for (auto &spur : spurs) {
+    frequency += 1.0 + ViReal64(NextRandom(state) % 100000);
+    spur.Frequency = frequency;
+    spur.Amplitude = -120.0 + 80.0 * ViReal64(NextRandom(state)) / 4294967296.0;
+  }
+  return spurs;
+}
+
+std::string MakeSpuriousList(const std::vector<CSpur> &spurs, bool isBlock) {
+  std::string reply{};
+  if (isBlock) {
+    std::vector<ViReal64> values{};
+    values.reserve(spurs.size() * 3);
+    for (const auto &spur : spurs) {
+      values.insert(values.end(), {spur.Frequency, spur.Amplitude, 0.0});
+    }
+    const auto length = std::to_string(values.size() * sizeof(ViReal64));
+    reply = "#" + std::to_string(length.size()) + length;
+    reply.append(reinterpret_cast<const char *>(values.data()),
+                 values.size() * sizeof(ViReal64));
+  } else {
+    std::array<char, 32> buf{};
+    for (const auto &spur : spurs) {
+      for (const auto value : {spur.Frequency, spur.Amplitude, 0.0}) {
+        if (!reply.empty()) reply += ',';
+        auto result = std::to_chars(buf.data(), buf.data() + buf.size(), value);
+        reply.append(buf.data(), result.ptr);
+      }
+    }
+  }
+  reply += '\n';
+  return reply;
+}
+
+std::vector<ViReal64> MakeSpuriousTrace(const std::vector<CSpur> &spurs) {
+  std::vector<ViReal64> trace{ViReal64(spurs.size())};
+  trace.reserve(1 + spurs.size() * 6);
+  for (std::size_t idx{}; idx < spurs.size(); ++idx) {
+    const auto &spur = spurs[idx];
+    trace.insert(trace.end(), {ViReal64(idx + 1), 1.0, spur.Frequency,
+                               spur.Amplitude, -30.0, 0.0});
+  }
+  return trace;
+}
+
+ViStatus Connect(ViConstString options, ViSession *vi) {
+  std::chrono::milliseconds delay{};
+  {
+    std::lock_guard<std::mutex> lock{g_Backend.Mutex};
+    delay = g_Backend.ConnectDelay;
+  }
+  std::this_thread::sleep_for(delay);
+  std::lock_guard<std::mutex> lock{g_Backend.Mutex};
+  if (g_Backend.ConnectStatus != VI_SUCCESS) return g_Backend.ConnectStatus;
+  // The IVI defaults apply to options left out.
+  g_Backend.InitOptions = options;
+  g_Backend.Attributes[{std::string{}, RangeCheckAttribute}] =
+      ParseOption(options, "RangeCheck", true);
+  g_Backend.Attributes[{std::string{}, QueryInstrumentStatusAttribute}] =
+      ParseOption(options, "QueryInstrStatus", false);
+  g_Backend.Attributes[{std::string{}, CacheAttribute}] =
+      ParseOption(options, "Cache", true);
+  g_Backend.DriverCache.clear();
+  *vi = ViSession(++g_Backend.Connects);
+  return VI_SUCCESS;
+}
+
+ViStatus Close() {
+  std::lock_guard<std::mutex> lock{g_Backend.Mutex};
+  ++g_Backend.Closes;
+  return VI_SUCCESS;
+}
+
+ViStatus Invalidate() {
+  std::lock_guard<std::mutex> lock{g_Backend.Mutex};
+  ++g_Backend.Invalidations;
+  g_Backend.DriverCache.clear();
+  return VI_SUCCESS;
+}
+
+ViStatus Write(ViConstString command) {
+  std::unique_lock<std::mutex> lock{g_Backend.Mutex};
+  Transact(lock);
+  if (g_Backend.IsWriteLogged) g_Backend.Writes.emplace_back(command);
+  if (std::strchr(command, '?') == nullptr) return VI_SUCCESS;
+  if (!g_Backend.Replies.empty()) {
+    g_Backend.Reply = std::move(g_Backend.Replies.front());
+    g_Backend.Replies.pop_front();
+    g_Backend.ReplyPos = 0;
+  } else if (!g_Backend.DefaultReply.empty()) {
+    g_Backend.Reply = g_Backend.DefaultReply;
+    g_Backend.ReplyPos = 0;
+  }
+  return VI_SUCCESS;
+}
+
+ViStatus Read(ViInt64 bufferSize, ViChar *buffer, ViInt64 *actualSize) {
+  std::lock_guard<std::mutex> lock{g_Backend.Mutex};
+  const auto size = std::min({std::size_t(bufferSize), g_Backend.ReadChunkMax,
+                              g_Backend.Reply.size() - g_Backend.ReplyPos});
+  std::memcpy(buffer, g_Backend.Reply.data() + g_Backend.ReplyPos, size);
+  g_Backend.ReplyPos += size;
+  *actualSize = ViInt64(size);
+  Spin(g_Backend.ByteCost * size);
+  if (g_Backend.ReplyPos < g_Backend.Reply.size()) return VI_SUCCESS_MAX_CNT;
+  g_Backend.Reply.clear();
+  g_Backend.ReplyPos = 0;
+  return VI_SUCCESS;
+}
+
+ViStatus Call(const char *function) {
+  std::lock_guard<std::mutex> lock{g_Backend.Mutex};
+  return (g_Backend.FailFunction == function) ? g_Backend.FailStatus
+                                              : VI_SUCCESS;
+}
+
+ViStatus Initiate(const char *function) {
+  std::lock_guard<std::mutex> lock{g_Backend.Mutex};
+  ++g_Backend.Initiates;
+  return (g_Backend.FailFunction == function) ? g_Backend.FailStatus
+                                              : VI_SUCCESS;
+}
+
+// Like the driver, reports the size needed and fills what fits.
+ViStatus FetchTrace(ViInt32 bufferSize, ViReal64 *buffer,
+                    ViInt32 *actualSize) {
+  std::lock_guard<std::mutex> lock{g_Backend.Mutex};
+  const auto &trace = g_Backend.Trace;
+  std::copy_n(trace.begin(), std::min(std::size_t(bufferSize), trace.size()),
+              buffer);
+  *actualSize = ViInt32(trace.size());
+  Spin(g_Backend.ByteCost * std::min(std::size_t(bufferSize), trace.size()) *
+       sizeof(ViReal64));
+  return VI_SUCCESS;
+}
+
+ViStatus SetAttribute(ViConstString repCap, ViAttr id, ViReal64 value) {
+  std::unique_lock<std::mutex> lock{g_Backend.Mutex};
+  ++g_Backend.AttributeWrites;
+  const std::pair<std::string, ViAttr> key{RepCapName(repCap), id};
+  auto &stored = g_Backend.Attributes[key];
+  const bool isCached{IsEnabled(CacheAttribute) &&
+                      (g_Backend.DriverCache.count(key) != 0) &&
+                      (stored == value)};
+  stored = value;
+  if (IsInherent(id) || isCached) return VI_SUCCESS;
+  Transact(lock);
+  if (IsEnabled(CacheAttribute)) g_Backend.DriverCache.insert(key);
+  return VI_SUCCESS;
+}
+
+ViStatus GetAttribute(ViConstString repCap, ViAttr id, ViReal64 &value) {
+  std::unique_lock<std::mutex> lock{g_Backend.Mutex};
+  ++g_Backend.AttributeReads;
+  const std::pair<std::string, ViAttr> key{RepCapName(repCap), id};
+  auto found = g_Backend.Attributes.find(key);
+  value = (found == g_Backend.Attributes.end()) ? 0.0 : found->second;
+  if (IsInherent(id) ||
+      (IsEnabled(CacheAttribute) && (g_Backend.DriverCache.count(key) != 0))) {
+    return VI_SUCCESS;
+  }
+  Transact(lock);
+  if (IsEnabled(CacheAttribute)) g_Backend.DriverCache.insert(key);
+  return VI_SUCCESS;
+}
+
+}  // namespace Stub
+
+extern "C" {
+
+ViStatus viEnableEvent(ViSession, ViEventType, ViUInt16, ViUInt32) {
+  return VI_SUCCESS;
+}
+
+ViStatus viDisableEvent(ViSession, ViEventType, ViUInt16) {
+  return VI_SUCCESS;
+}
+
+ViStatus viDiscardEvents(ViSession, ViEventType, ViUInt16) {
+  return VI_SUCCESS;
+}
+
+ViStatus viWaitOnEvent(ViSession, ViEventType, ViUInt32, ViEventType *,
+                       ViEvent *) {
+  return VI_ERROR_TMO;
+}
+
+ViStatus viClose(ViObject) { return VI_SUCCESS; }
+
+ViStatus viReadSTB(ViSession, ViUInt16 *status) {
+  std::lock_guard<std::mutex> lock{Stub::Backend().Mutex};
+  *status = 0;
+  return Stub::Backend().StatusByteStatus;
+}
+
+}  // extern "C"
@@ -0,0 +1,125 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef STUB_BACKEND_H
+#define STUB_BACKEND_H
+
+// Scriptable in-process replacement of the instrument drivers and VISA. Both
+// stub drivers share one backend: every write is logged, each query (a write
+// containing '?') takes the next scripted reply, and attributes are kept in
+// a map. Tests script it from the main thread before the wrappers run;
+// driver calls from other threads are serialized by Mutex, all but the
+// IoLatency they wait out.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "IviVisaType.h"
+
+namespace Stub {
+
+struct CBackend {
+  std::mutex Mutex{};
+  // Queries and their replies; benchmarks turn the write log off.
+  std::vector<std::string> Writes{};
+  bool IsWriteLogged{true};
+  std::deque<std::string> Replies{};
+  // Answers every query once Replies runs out, e.g. in benchmark loops.
+  std::string DefaultReply{};
+  std::string Reply{};
+  std::size_t ReplyPos{};
+  // Largest chunk a single viRead returns, to split replies.
+  std::size_t ReadChunkMax{1024};
+  // Attribute values by repeated capability and ID, any type as ViReal64.
+  std::map<std::pair<std::string, ViAttr>, ViReal64> Attributes{};
+  std::size_t AttributeWrites{};
+  std::size_t AttributeReads{};
+  std::size_t Invalidations{};
+  // Driver side of the init options, which Connect stores as the inherent
+  // attributes: with Cache on, a setting the driver already sent is not
+  // sent again; with QueryInstrStatus on, every instrument access is
+  // followed by an error query.
+  std::string InitOptions{};
+  std::set<std::pair<std::string, ViAttr>> DriverCache{};
+  // Instrument accesses and the time each one takes, plus the transfer
+  // time of every byte read.
+  std::size_t Transactions{};
+  std::chrono::microseconds IoLatency{};
+  std::chrono::nanoseconds ByteCost{};
+  // Sessions.
+  std::size_t Connects{};
+  std::size_t Closes{};
+  std::chrono::milliseconds ConnectDelay{};
+  ViStatus ConnectStatus{VI_SUCCESS};
+  ViStatus StatusByteStatus{VI_SUCCESS};
+  // Calls of the named driver function fail with FailStatus.
+  std::string FailFunction{};
+  ViStatus FailStatus{VI_SUCCESS};
+  // AgXSAn spurious trace: the count followed by the records.
+  std::vector<ViReal64> Trace{};
+  std::size_t Initiates{};
+};
+
+CBackend &Backend();
+// Forgets everything scripted and logged.
+void Reset();
+
+// Synthetic spurs, the same for the same seed on every platform:
+// frequencies ascending from 1 MHz, amplitudes within -120..-40 dBm.
+struct CSpur {
+  ViReal64 Frequency{};
+  ViReal64 Amplitude{};
+};
+std::vector<CSpur> GenerateSpurs(std::size_t spursNum, std::uint32_t seed);
+// The E5052B :SPUR:SLIS? reply for them: frequency, amplitude and 0 per
+// spur, in ASCII or as a REAL,64 definite length block in host byte order.
+std::string MakeSpuriousList(const std::vector<CSpur> &spurs, bool isBlock);
+// The N9030A spurious trace for them: the count, then number, range,
+// frequency, amplitude, limit and 0 per spur.
+std::vector<ViReal64> MakeSpuriousTrace(const std::vector<CSpur> &spurs);
+
+// Shared implementation of the driver entry points.
+ViStatus Connect(ViConstString options, ViSession *vi);
+ViStatus Close();
+ViStatus Invalidate();
+ViStatus Write(ViConstString command);
+ViStatus Read(ViInt64 bufferSize, ViChar *buffer, ViInt64 *actualSize);
+ViStatus Call(const char *function);
+ViStatus Initiate(const char *function);
+ViStatus FetchTrace(ViInt32 bufferSize, ViReal64 *buffer, ViInt32 *actualSize);
+ViStatus SetAttribute(ViConstString repCap, ViAttr id, ViReal64 value);
+ViStatus GetAttribute(ViConstString repCap, ViAttr id, ViReal64 &value);
+
+}  // namespace Stub
+
+#endif  // STUB_BACKEND_H
@@ -0,0 +1,59 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef VISA_STUB_H
+#define VISA_STUB_H
+
+// Stand-in for visa.h: the event and status byte calls of the wrappers,
+// implemented by the stub backend.
+
+#include "IviVisaType.h"
+
+#define VI_EVENT_SERVICE_REQ 0x3FFF200B
+#define VI_QUEUE 1
+#define VI_ALL_MECH 0xFFFF
+#define VI_TMO_INFINITE 0xFFFFFFFF
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+ViStatus viEnableEvent(ViSession vi, ViEventType eventType, ViUInt16 mechanism,
+                       ViUInt32 context);
+ViStatus viDisableEvent(ViSession vi, ViEventType eventType,
+                        ViUInt16 mechanism);
+ViStatus viDiscardEvents(ViSession vi, ViEventType eventType,
+                         ViUInt16 mechanism);
+ViStatus viWaitOnEvent(ViSession vi, ViEventType inEventType,
+                       ViUInt32 timeout, ViEventType *outEventType,
+                       ViEvent *outContext);
+ViStatus viClose(ViObject vi);
+ViStatus viReadSTB(ViSession vi, ViUInt16 *status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // VISA_STUB_H
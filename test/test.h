@@ -0,0 +1,57 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef IVI_TEST_H
+#define IVI_TEST_H
+
+// Minimal test harness: CHECK records a failure and carries on, so one run
+// reports every broken expectation; main returns Test::Result().
+
+#include <cstdio>
+
+namespace Test {
+
+inline int g_Failures{};
+
+inline bool Check(bool isPassed, const char *expression, const char *file,
+                  int line) {
+  if (!isPassed) {
+    ++g_Failures;
+    std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expression);
+  }
+  return isPassed;
+}
+
+inline int Result() {
+  if (g_Failures != 0) std::fprintf(stderr, "%d check(s) failed\n", g_Failures);
+  return (g_Failures == 0) ? 0 : 1;
+}
+
+}  // namespace Test
+
+#define CHECK(expression) \
+  ::Test::Check(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
+
+#endif  // IVI_TEST_H
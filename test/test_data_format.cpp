@@ -0,0 +1,149 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "agssa_wrapper.h"
+#include "ivi_scpi.h"
+#include "stub_backend.h"
+#include "test.h"
+
+namespace {
+
+namespace Measurements = AgSsa::Application::PN::Measurements;
+
+constexpr std::size_t SpursNum{500};
+constexpr std::uint32_t SpursSeed{7};
+
+bool IsEqual(const Measurements::CSpursData &spursData,
+             const std::vector<Stub::CSpur> &spurs) {
+  if (spursData.size() != spurs.size()) return false;
+  for (std::size_t idx{}; idx < spurs.size(); ++idx) {
+    if ((spursData[idx].Frequency != spurs[idx].Frequency) ||
+        (spursData[idx].Amplitude != spurs[idx].Amplitude)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Answers the next spurious list query in the format the wrapper expects
+// and checks the spurs come out unchanged.
+bool QueryMatches(const AgSsa::CAgSsa &ssa, bool isBlock) {
+  const auto spurs = Stub::GenerateSpurs(SpursNum, SpursSeed);
+  Stub::Backend().Replies.push_back(Stub::MakeSpuriousList(spurs, isBlock));
+  Measurements::CSpursData spursData{};
+  const auto status =
+      ssa.Application.PN.Measurements.QuerySpuriousList(spursData);
+  return (status == VI_SUCCESS) && IsEqual(spursData, spurs);
+}
+
+void TestGenerator() {
+  const auto spurs = Stub::GenerateSpurs(SpursNum, SpursSeed);
+  CHECK(spurs.size() == SpursNum);
+  CHECK(spurs.front().Frequency > 1e6);
+  CHECK(spurs.front().Amplitude >= -120.0);
+  CHECK(spurs.front().Amplitude < -40.0);
+  const auto again = Stub::GenerateSpurs(SpursNum, SpursSeed);
+  CHECK(again.back().Frequency == spurs.back().Frequency);
+  CHECK(again.back().Amplitude == spurs.back().Amplitude);
+}
+
+void TestBothFormats() {
+  Stub::Reset();
+  AgSsa::CAgSsa ssa{};
+  CHECK(ssa.Connect("TCPIP0::ssa::INSTR", AgSsa::CAgSsaOptions{}) ==
+        VI_SUCCESS);
+  const auto &measurements = ssa.Application.PN.Measurements;
+  CHECK(QueryMatches(ssa, false));
+  CHECK(measurements.ConfigureDataFormat(Measurements::DataFormat::Real64) ==
+        VI_SUCCESS);
+  CHECK(QueryMatches(ssa, true));
+  CHECK(measurements.ConfigureDataFormat(Measurements::DataFormat::ASCii) ==
+        VI_SUCCESS);
+  CHECK(QueryMatches(ssa, false));
+  ssa.Close();
+}
+
+// Dropping the attribute caches leaves :FORM:DATA alone, so the wrapper
+// has to keep expecting binary blocks.
+void TestFormatSurvivesInvalidation() {
+  Stub::Reset();
+  AgSsa::CAgSsa ssa{};
+  CHECK(ssa.Connect("TCPIP0::ssa::INSTR", AgSsa::CAgSsaOptions{}) ==
+        VI_SUCCESS);
+  const auto &measurements = ssa.Application.PN.Measurements;
+  CHECK(measurements.ConfigureDataFormat(Measurements::DataFormat::Real64) ==
+        VI_SUCCESS);
+  CHECK(ssa.Application.PN.AutoSettings() == VI_SUCCESS);
+  CHECK(QueryMatches(ssa, true));
+  Scpi::CScpiBatch batch{};
+  batch.Add(":DISP:MAX", true);
+  Stub::Backend().Replies.push_back("1;0,\"No error\"\n");
+  ViInt32 errorCode{};
+  CHECK(ssa.System.Execute(batch, errorCode) == VI_SUCCESS);
+  CHECK(QueryMatches(ssa, true));
+  ssa.Close();
+}
+
+// A reset and a new session take the instrument back to ASCII.
+void TestFormatRevertsOnReset() {
+  Stub::Reset();
+  AgSsa::CAgSsa ssa{};
+  CHECK(ssa.Connect("TCPIP0::ssa::INSTR", AgSsa::CAgSsaOptions{}) ==
+        VI_SUCCESS);
+  const auto &measurements = ssa.Application.PN.Measurements;
+  CHECK(measurements.ConfigureDataFormat(Measurements::DataFormat::Real64) ==
+        VI_SUCCESS);
+  CHECK(ssa.Utility.Reset() == VI_SUCCESS);
+  CHECK(QueryMatches(ssa, false));
+  CHECK(measurements.ConfigureDataFormat(Measurements::DataFormat::Real64) ==
+        VI_SUCCESS);
+  Scpi::CScpiBatch batch{};
+  batch.Add("*RST");
+  Stub::Backend().Replies.push_back("1;0,\"No error\"\n");
+  ViInt32 errorCode{};
+  CHECK(ssa.System.Execute(batch, errorCode) == VI_SUCCESS);
+  CHECK(QueryMatches(ssa, false));
+  CHECK(measurements.ConfigureDataFormat(Measurements::DataFormat::Real64) ==
+        VI_SUCCESS);
+  ssa.Close();
+  CHECK(ssa.Connect("TCPIP0::ssa::INSTR", AgSsa::CAgSsaOptions{}) ==
+        VI_SUCCESS);
+  CHECK(QueryMatches(ssa, false));
+  ssa.Close();
+}
+
+}  // namespace
+
+int main() {
+  TestGenerator();
+  TestBothFormats();
+  TestFormatSurvivesInvalidation();
+  TestFormatRevertsOnReset();
+  return Test::Result();
+}
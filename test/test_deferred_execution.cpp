@@ -0,0 +1,102 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <string_view>
+#include <vector>
+
+#include "agssa_wrapper.h"
+#include "ivi_deferred_errors.h"
+#include "stub_backend.h"
+#include "test.h"
+
+namespace {
+
+void TestJournalAttribution() {
+  CIviCallJournal journal{};
+  journal.Clear();
+  journal.Record("AgSsa_SetAttributeViInt32", VI_SUCCESS);
+  journal.Record("AgSsa_GetAttributeViReal64", VI_SUCCESS);
+  journal.Record("AgSsa_SetAttributeViBoolean", VI_ERROR_TMO);
+  journal.Record("AgSsa_SetAttributeViReal64", VI_SUCCESS);
+  std::vector<CIviDeferredError> errors{
+      {-222, "Data out of range"}, {-410, "Query INTERRUPTED"}, {-113, ""}};
+  journal.Attribute(errors);
+  // The failed command is preferred over the later one.
+  CHECK(errors[2].Call == 2);
+  CHECK(errors[2].Function == "AgSsa_SetAttributeViBoolean");
+  // Errors are matched in queue order, never to a later call.
+  CHECK(errors[1].Call == 1);
+  CHECK(errors[0].Call == 0);
+  std::vector<CIviDeferredError> unmatched{{-410, ""}};
+  journal.Clear();
+  journal.Record("AgSsa_SetAttributeViInt32", VI_SUCCESS);
+  journal.Attribute(unmatched);
+  CHECK(unmatched[0].Call == CIviDeferredError::NoCall);
+  CHECK(unmatched[0].Function.empty());
+}
+
+void TestExecuteDeferred() {
+  Stub::Reset();
+  AgSsa::CAgSsa ssa{};
+  CHECK(ssa.Connect("TCPIP0::ssa::INSTR", AgSsa::CAgSsaOptions{}) ==
+        VI_SUCCESS);
+  auto &queryStatus =
+      Stub::Backend().Attributes[{"", AGSSA_ATTR_QUERY_INSTRUMENT_STATUS}];
+  queryStatus = 1;
+  Stub::Backend().Replies = {"-113,\"Undefined header\"\n",
+                             "-410,\"Query INTERRUPTED\"\n",
+                             "0,\"No error\"\n"};
+  std::vector<CIviDeferredError> errors{};
+  int correlation{};
+  const auto status = ssa.System.ExecuteDeferred(
+      [&] {
+        auto status = ssa.Display.ConfigureMaximize();
+        if (status != VI_SUCCESS) return status;
+        return ssa.Application.PN.Aquisition.QueryCorrelation(correlation);
+      },
+      errors);
+  CHECK(status == VI_SUCCESS);
+  CHECK(errors.size() == 2);
+  if (errors.size() == 2) {
+    CHECK(errors[0].Code == -113);
+    CHECK(errors[0].Description == "Undefined header");
+    CHECK(errors[0].Function == "AgSsa_SetAttributeViBoolean");
+    CHECK(errors[1].Code == -410);
+    CHECK(errors[1].Function == "AgSsa_GetAttributeViInt32");
+  }
+  std::vector<std::string> drained(3, ":SYST:ERR?");
+  CHECK(Stub::Backend().Writes == drained);
+  // The status query is restored once the sequence has run.
+  CHECK(queryStatus == 1);
+  ssa.Close();
+}
+
+}  // namespace
+
+int main() {
+  TestJournalAttribution();
+  TestExecuteDeferred();
+  return Test::Result();
+}
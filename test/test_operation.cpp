@@ -0,0 +1,198 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ivi_operation.h"
+#include "test.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Local stand-in for an instrument raising SRQ: *OPC completes the sweep
+// after SweepTime on a thread of its own and, with the service request
+// enabled, signals it the way the VISA event queue would.
+struct CSrqIo {
+  inline static std::mutex Mutex{};
+  inline static std::condition_variable Condition{};
+  inline static std::vector<std::string> Writes{};
+  inline static std::string Reply{};
+  inline static bool IsDone{};
+  inline static bool IsEnabled{};
+  inline static bool IsRequested{};
+  inline static Clock::time_point DoneTime{};
+  inline static std::chrono::milliseconds SweepTime{150};
+  inline static std::thread Sweep{};
+
+  static void Reset() {
+    if (Sweep.joinable()) Sweep.join();
+    std::lock_guard<std::mutex> lock{Mutex};
+    Writes.clear();
+    Reply.clear();
+    IsDone = false;
+    IsEnabled = false;
+    IsRequested = false;
+  }
+  static ViStatus Write(CIviInnerSession &, ViConstString command) {
+    const std::string text{command};
+    // The previous sweep takes the lock when it ends.
+    if ((text == "*OPC") && Sweep.joinable()) Sweep.join();
+    std::lock_guard<std::mutex> lock{Mutex};
+    Writes.push_back(text);
+    if (text == "*ESR?") {
+      // Reading the register clears it.
+      Reply = IsDone ? "1\n" : "0\n";
+      IsDone = false;
+    } else if (text == "*ESE?") {
+      Reply = "4\n";
+    } else if (text == "*SRE?") {
+      Reply = "16\n";
+    } else if (text == "*OPC") {
+      Sweep = std::thread{[] {
+        std::this_thread::sleep_for(SweepTime);
+        std::lock_guard<std::mutex> lock{Mutex};
+        IsDone = true;
+        DoneTime = Clock::now();
+        if (IsEnabled) {
+          IsRequested = true;
+          Condition.notify_all();
+        }
+      }};
+    }
+    return VI_SUCCESS;
+  }
+  static ViStatus Read(CIviInnerSession &, ViChar *buffer, ViInt64 size,
+                       ViInt64 *retSize) {
+    std::lock_guard<std::mutex> lock{Mutex};
+    const auto count = std::min(std::size_t(size), Reply.size());
+    std::memcpy(buffer, Reply.data(), count);
+    *retSize = ViInt64(count);
+    Reply.clear();
+    return VI_SUCCESS;
+  }
+  static ViStatus EnableServiceRequest(CIviInnerSession &, bool enabled) {
+    std::lock_guard<std::mutex> lock{Mutex};
+    IsEnabled = enabled;
+    if (!enabled) IsRequested = false;
+    return VI_SUCCESS;
+  }
+  static ViStatus WaitForServiceRequest(CIviInnerSession &, ViUInt32 timeout,
+                                        ViUInt16 &statusByte) {
+    std::unique_lock<std::mutex> lock{Mutex};
+    if (!Condition.wait_for(lock, std::chrono::milliseconds{timeout},
+                            [] { return IsRequested; })) {
+      return VI_ERROR_TMO;
+    }
+    IsRequested = false;
+    statusByte = 0x60;
+    return VI_SUCCESS;
+  }
+  static bool IsWritten(const std::string &command) {
+    std::lock_guard<std::mutex> lock{Mutex};
+    return std::find(Writes.begin(), Writes.end(), command) != Writes.end();
+  }
+  static std::string LastWrite() {
+    std::lock_guard<std::mutex> lock{Mutex};
+    return Writes.empty() ? std::string{} : Writes.back();
+  }
+};
+
+ViStatus Abort(CIviInnerSession &) { return VI_ERROR_ABORT; }
+
+void TestServiceRequest() {
+  CSrqIo::Reset();
+  CIviInnerSession session{};
+  {
+    CIviOperation<CSrqIo> operation{session, nullptr,
+                                    CompletionMode::ServiceRequest};
+    CHECK(operation.Start([] { return VI_SUCCESS; }) == VI_SUCCESS);
+    CHECK(CSrqIo::IsWritten("*ESE 5;*SRE 48"));
+    CHECK(CSrqIo::LastWrite() == "*OPC");
+    CHECK(operation.Wait(std::chrono::seconds{2}) == VI_SUCCESS);
+    // Woken up by the request, not by a poll interval.
+    const auto latency = Clock::now() - CSrqIo::DoneTime;
+    CHECK(operation.IsComplete());
+    CHECK(latency < std::chrono::milliseconds{50});
+    // The previous enable masks are back once the sweep is done.
+    CHECK(CSrqIo::LastWrite() == "*ESE 4;*SRE 16");
+    CHECK(!CSrqIo::IsEnabled);
+  }
+  CSrqIo::Reset();
+}
+
+void TestServiceRequestTimeout() {
+  CSrqIo::Reset();
+  CIviInnerSession session{};
+  {
+    CIviOperation<CSrqIo> operation{session, nullptr,
+                                    CompletionMode::ServiceRequest};
+    CHECK(operation.Start([] { return VI_SUCCESS; }) == VI_SUCCESS);
+    const auto start = Clock::now();
+    CHECK(operation.Wait(std::chrono::milliseconds{50}) == VI_ERROR_TMO);
+    CHECK(Clock::now() - start < std::chrono::milliseconds{140});
+    CHECK(!operation.IsComplete());
+    CHECK(CSrqIo::IsEnabled);
+  }
+  // Destroying a pending operation restores the masks too.
+  CHECK(CSrqIo::LastWrite() == "*ESE 4;*SRE 16");
+  CHECK(!CSrqIo::IsEnabled);
+  CSrqIo::Reset();
+}
+
+void TestPollingAndCancel() {
+  CSrqIo::Reset();
+  CIviInnerSession session{};
+  CIviOperation<CSrqIo> operation{session, Abort};
+  CHECK(operation.Start([] { return VI_SUCCESS; }) == VI_SUCCESS);
+  CHECK(!CSrqIo::IsWritten("*ESE?"));
+  CHECK(operation.Wait(std::chrono::seconds{2}) == VI_SUCCESS);
+  CHECK(operation.IsComplete());
+  CSrqIo::Reset();
+  CHECK(operation.Start([] { return VI_SUCCESS; }) == VI_SUCCESS);
+  CHECK(operation.Cancel() == VI_ERROR_ABORT);
+  CHECK(!operation.IsStarted());
+  bool isComplete{};
+  CHECK(operation.Poll(isComplete) == VI_ERROR_INV_OBJECT);
+  CHECK(operation.Start([] { return VI_ERROR_TMO; }) == VI_ERROR_TMO);
+  CHECK(!operation.IsStarted());
+  CSrqIo::Reset();
+}
+
+}  // namespace
+
+int main() {
+  TestServiceRequest();
+  TestServiceRequestTimeout();
+  TestPollingAndCancel();
+  return Test::Result();
+}
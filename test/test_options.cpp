@@ -0,0 +1,102 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <string>
+
+#include "agssa_wrapper.h"
+#include "agxsan_wrapper.h"
+#include "ivi_options.h"
+#include "test.h"
+
+namespace {
+
+// Option structs as callers wrote them before the driver options existed.
+struct CLegacyOptions {
+  int Model{};
+  bool Simulate{};
+  bool Reset{};
+  bool idQuery{};
+};
+
+struct CCurrentOptions : CIviDriverOptions {
+  int Model{};
+  bool Simulate{};
+  bool Reset{};
+  bool idQuery{};
+  bool AttributeCache{};
+};
+
+void TestLegacyConversion() {
+  const CLegacyOptions legacy{int(AgSsa::AgSsaModel::E5052B), true, false,
+                              true};
+  const AgSsa::CAgSsaOptions ssaOptions{legacy};
+  CHECK(ssaOptions.Model == AgSsa::AgSsaModel::E5052B);
+  CHECK(ssaOptions.Simulate);
+  CHECK(!ssaOptions.Reset);
+  CHECK(ssaOptions.idQuery);
+  CHECK(!ssaOptions.AttributeCache);
+  CHECK(static_cast<const CIviDriverOptions &>(ssaOptions) ==
+        CIviDriverOptions{});
+  const AgXSAn::CAgXSAnOptions xsanOptions{legacy};
+  CHECK(xsanOptions.Simulate);
+  CHECK(!xsanOptions.AttributeCache);
+  CHECK(static_cast<const CIviDriverOptions &>(xsanOptions) ==
+        CIviDriverOptions{});
+}
+
+void TestCurrentConversion() {
+  CCurrentOptions current{};
+  current.Cache = true;
+  current.RangeCheck = false;
+  current.DriverSetup = {{"TraceArraySize", "4096"}};
+  current.AttributeCache = true;
+  const AgSsa::CAgSsaOptions ssaOptions{current};
+  CHECK(ssaOptions.AttributeCache);
+  CHECK(static_cast<const CIviDriverOptions &>(ssaOptions) ==
+        static_cast<const CIviDriverOptions &>(current));
+  const AgXSAn::CAgXSAnOptions xsanOptions{current};
+  CHECK(xsanOptions.AttributeCache);
+  CHECK(xsanOptions.Cache == true);
+}
+
+void TestMakeString() {
+  CIviDriverOptions options{};
+  CHECK(IviOptions::MakeString(options, false, "") == "Simulate=false");
+  options.RangeCheck = false;
+  options.Cache = true;
+  options.DriverSetup = {{"TraceArraySize", "4096"}};
+  CHECK(IviOptions::MakeString(options, true, "E5052B") ==
+        "RangeCheck=false, Cache=true, Simulate=true, "
+        "DriverSetup=Model=E5052B, TraceArraySize=4096");
+}
+
+}  // namespace
+
+int main() {
+  TestLegacyConversion();
+  TestCurrentConversion();
+  TestMakeString();
+  return Test::Result();
+}
@@ -0,0 +1,157 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <vector>
+
+#include "agssa_wrapper.h"
+#include "ivi_orchestrator.h"
+#include "stub_backend.h"
+#include "test.h"
+
+namespace {
+
+using ClockType = std::chrono::steady_clock;
+
+// Records the order its tasks ran in and whether two of them overlapped.
+struct CRecorder {
+  std::vector<int> Order{};
+  std::atomic<int> Running{};
+  bool IsOverlapped{};
+};
+
+void TestStrandOrder() {
+  CIviOrchestrator orchestrator{4};
+  auto first = orchestrator.Add<CRecorder>("first");
+  auto second = orchestrator.Add<CRecorder>("second");
+  const int tasksNum{200};
+  std::vector<std::future<ViStatus>> results{};
+  for (int idx{}; idx < tasksNum; ++idx) {
+    for (const auto *instrument : {&first, &second}) {
+      results.push_back(
+          orchestrator.Submit(*instrument, [idx](CRecorder &recorder) {
+            if (++recorder.Running != 1) recorder.IsOverlapped = true;
+            recorder.Order.push_back(idx);
+            --recorder.Running;
+            return ViStatus{VI_SUCCESS};
+          }));
+    }
+  }
+  orchestrator.WaitAll();
+  for (auto &result : results) {
+    CHECK(result.wait_for(std::chrono::seconds{0}) ==
+          std::future_status::ready);
+    CHECK(result.get() == VI_SUCCESS);
+  }
+  for (const auto *instrument : {&first, &second}) {
+    const auto &recorder = instrument->Instance;
+    CHECK(!recorder.IsOverlapped);
+    CHECK(recorder.Order.size() == std::size_t(tasksNum));
+    bool isOrdered{true};
+    for (int idx{}; idx < int(recorder.Order.size()); ++idx) {
+      isOrdered = isOrdered && (recorder.Order[idx] == idx);
+    }
+    CHECK(isOrdered);
+  }
+  const auto utilization = orchestrator.GetUtilization();
+  CHECK(utilization.size() == 2);
+  CHECK(utilization[0].Name == "first");
+  CHECK(utilization[0].Tasks == std::uint64_t(tasksNum));
+  CHECK(utilization[1].Name == "second");
+  CHECK(utilization[1].Tasks == std::uint64_t(tasksNum));
+}
+
+// Three stub instruments: each connect takes ConnectDelay and each
+// configure an IoLatency round trip. The slowest one needs four times the
+// configures of the others; run in parallel, the station takes about as
+// long as it does.
+void TestParallelInstruments() {
+  const auto connectDelay = std::chrono::milliseconds{100};
+  const auto ioLatency = std::chrono::milliseconds{2};
+  const std::size_t configuresNum{10};
+  const std::size_t slowConfiguresNum{40};
+  Stub::Reset();
+  Stub::Backend().IsWriteLogged = false;
+  Stub::Backend().ConnectDelay = connectDelay;
+  Stub::Backend().IoLatency = ioLatency;
+  CIviOrchestrator orchestrator{3};
+  std::vector<CIviOrchestrator::CInstrument<AgSsa::CAgSsa>> instruments{
+      orchestrator.Add<AgSsa::CAgSsa>("slow"),
+      orchestrator.Add<AgSsa::CAgSsa>("fast1"),
+      orchestrator.Add<AgSsa::CAgSsa>("fast2")};
+  std::vector<std::future<ViStatus>> results{};
+  const auto start = ClockType::now();
+  for (std::size_t idx{}; idx < instruments.size(); ++idx) {
+    results.push_back(
+        orchestrator.Submit(instruments[idx], [](AgSsa::CAgSsa &ssa) {
+          return ssa.Connect("TCPIP0::ssa::INSTR", AgSsa::CAgSsaOptions{});
+        }));
+    const auto num = (idx == 0) ? slowConfiguresNum : configuresNum;
+    for (std::size_t configure{}; configure < num; ++configure) {
+      const bool isMaximized{configure % 2 == 0};
+      results.push_back(orchestrator.Submit(
+          instruments[idx], [isMaximized](AgSsa::CAgSsa &ssa) {
+            return ssa.Display.ConfigureMaximize(isMaximized);
+          }));
+    }
+  }
+  orchestrator.WaitAll();
+  const auto elapsed = ClockType::now() - start;
+  bool isSucceeded{true};
+  for (auto &result : results) {
+    isSucceeded = isSucceeded && (result.get() == VI_SUCCESS);
+  }
+  CHECK(isSucceeded);
+  const auto slowest = connectDelay + ioLatency * slowConfiguresNum;
+  const auto serial = connectDelay * instruments.size() +
+                      ioLatency * (slowConfiguresNum + 2 * configuresNum);
+  CHECK(elapsed >= slowest);
+  CHECK(elapsed < slowest + (serial - slowest) / 2);
+  const auto utilization = orchestrator.GetUtilization();
+  CHECK(utilization.size() == 3);
+  CHECK(utilization[0].Tasks == slowConfiguresNum + 1);
+  CHECK(utilization[1].Tasks == configuresNum + 1);
+  CHECK(utilization[0].Busy >= slowest);
+  CHECK(utilization[0].Busy > utilization[1].Busy);
+  CHECK(utilization[0].Ratio() > 0.5);
+  CHECK(utilization[0].Ratio() <= 1.0);
+  orchestrator.ResetUtilization();
+  const auto reset = orchestrator.GetUtilization();
+  CHECK(reset[0].Tasks == 0);
+  CHECK(reset[0].Busy == ClockType::duration{});
+  for (const auto &instrument : instruments) instrument.Instance.Close();
+}
+
+}  // namespace
+
+int main() {
+  TestStrandOrder();
+  TestParallelInstruments();
+  return Test::Result();
+}
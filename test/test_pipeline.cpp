@@ -0,0 +1,159 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ivi_pipeline.h"
+#include "test.h"
+
+namespace {
+
+// Records the pipeline calls in order; process entries are appended from the
+// worker thread.
+struct CCalls {
+  std::mutex Mutex{};
+  std::vector<std::string> Entries{};
+
+  void Add(std::string entry) {
+    std::lock_guard<std::mutex> lock{Mutex};
+    Entries.push_back(std::move(entry));
+  }
+  std::size_t Find(const std::string &entry) {
+    std::lock_guard<std::mutex> lock{Mutex};
+    for (std::size_t idx{}; idx < Entries.size(); ++idx) {
+      if (Entries[idx] == entry) return idx;
+    }
+    return Entries.size();
+  }
+};
+
+void TestEverySweepIsProcessed() {
+  CIviPipeline<std::vector<int>> pipeline{};
+  CCalls calls{};
+  int sweep{};
+  std::vector<int> processed{};
+  const auto status = pipeline.Run(
+      4,
+      [&] {
+        calls.Add("initiate");
+        return VI_SUCCESS;
+      },
+      [&] {
+        calls.Add("wait");
+        return VI_SUCCESS;
+      },
+      [&](std::vector<int> &results) {
+        calls.Add("fetch " + std::to_string(sweep));
+        results.assign(3, sweep++);
+        return VI_SUCCESS;
+      },
+      [&](const std::vector<int> &results, std::size_t sweepIdx) {
+        calls.Add("process " + std::to_string(sweepIdx));
+        processed.push_back(results.front());
+        return VI_SUCCESS;
+      });
+  CHECK(status == VI_SUCCESS);
+  CHECK(processed == (std::vector<int>{0, 1, 2, 3}));
+  CHECK(calls.Entries.size() == 16);
+  CHECK(calls.Entries.front() == "initiate");
+  // The next sweep is initiated right after the fetch, before processing.
+  CHECK(calls.Entries[2] == "fetch 0");
+  CHECK(calls.Entries[3] == "initiate");
+  CHECK(calls.Find("process 0") > calls.Find("fetch 0"));
+  // Sweep N is processed before sweep N + 2 is fetched into its buffer.
+  CHECK(calls.Find("process 0") < calls.Find("fetch 2"));
+  CHECK(calls.Find("process 1") < calls.Find("fetch 3"));
+  CHECK(calls.Find("process 3") == calls.Entries.size() - 1);
+}
+
+void TestStopsOnFetchFailure() {
+  CIviPipeline<std::vector<int>> pipeline{};
+  std::size_t initiates{};
+  std::size_t processes{};
+  std::size_t fetches{};
+  const auto status = pipeline.Run(
+      5,
+      [&] {
+        ++initiates;
+        return VI_SUCCESS;
+      },
+      [] { return VI_SUCCESS; },
+      [&](std::vector<int> &) {
+        return (++fetches == 3) ? VI_ERROR_TMO : VI_SUCCESS;
+      },
+      [&](const std::vector<int> &, std::size_t) {
+        ++processes;
+        return VI_SUCCESS;
+      });
+  CHECK(status == VI_ERROR_TMO);
+  CHECK(fetches == 3);
+  CHECK(initiates == 3);
+  CHECK(processes == 2);
+}
+
+void TestStopsOnProcessFailure() {
+  CIviPipeline<int> pipeline{};
+  std::size_t fetches{};
+  const auto status = pipeline.Run(
+      5, [] { return VI_SUCCESS; }, [] { return VI_SUCCESS; },
+      [&](int &) {
+        ++fetches;
+        return VI_SUCCESS;
+      },
+      [](const int &, std::size_t sweepIdx) {
+        return (sweepIdx == 1) ? VI_ERROR_INV_SETUP : VI_SUCCESS;
+      });
+  CHECK(status == VI_ERROR_INV_SETUP);
+  // The failure of sweep 1 is collected after sweep 2 has been fetched.
+  CHECK(fetches == 3);
+}
+
+void TestNoSweeps() {
+  CIviPipeline<int> pipeline{};
+  bool isCalled{};
+  const auto status = pipeline.Run(
+      0,
+      [&] {
+        isCalled = true;
+        return VI_SUCCESS;
+      },
+      [] { return VI_SUCCESS; }, [](int &) { return VI_SUCCESS; },
+      [](const int &, std::size_t) { return VI_SUCCESS; });
+  CHECK(status == VI_SUCCESS);
+  CHECK(!isCalled);
+}
+
+}  // namespace
+
+int main() {
+  TestEverySweepIsProcessed();
+  TestStopsOnFetchFailure();
+  TestStopsOnProcessFailure();
+  TestNoSweeps();
+  return Test::Result();
+}
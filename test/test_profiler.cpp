@@ -0,0 +1,112 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include "ivi_profiler.h"
+#include "test.h"
+
+namespace {
+
+void TestHistogramExactBuckets() {
+  CIviLatencyHistogram histogram{};
+  CHECK(histogram.Percentile(50) == 0);
+  for (std::uint64_t value{}; value < 16; ++value) histogram.Record(value);
+  CHECK(histogram.TotalCount() == 16);
+  CHECK(histogram.Percentile(0) == 0);
+  CHECK(histogram.Percentile(50) == 8);
+  CHECK(histogram.Percentile(100) == 15);
+}
+
+// Every value lands in a bucket whose lower bound is within 1/16 of it.
+void TestHistogramResolution() {
+  bool isWithinBound{true};
+  for (std::uint64_t value{16}; value < (std::uint64_t(1) << 40);
+       value = value * 3 + 7) {
+    CIviLatencyHistogram histogram{};
+    histogram.Record(value);
+    const auto bound = histogram.Percentile(50);
+    isWithinBound = isWithinBound && (bound <= value) &&
+                    (value - bound <= value / 16);
+  }
+  CHECK(isWithinBound);
+  CIviLatencyHistogram histogram{};
+  histogram.Record(std::numeric_limits<std::uint64_t>::max());
+  CHECK(histogram.Percentile(100) >= (std::uint64_t(15) << 60));
+}
+
+void TestHistogramPercentiles() {
+  CIviLatencyHistogram histogram{};
+  for (int idx{}; idx < 90; ++idx) histogram.Record(1000);
+  for (int idx{}; idx < 10; ++idx) histogram.Record(1000000);
+  CHECK(histogram.Percentile(50) <= 1000);
+  CHECK(histogram.Percentile(50) > 1000 - 1000 / 16);
+  CHECK(histogram.Percentile(99) > 1000000 - 1000000 / 16);
+}
+
+void TestProfiler() {
+  CIviCallProfiler profiler{};
+  profiler.Record("AgSsa_viRead", std::chrono::nanoseconds{100}, VI_SUCCESS);
+  profiler.Record("AgSsa_viRead", std::chrono::nanoseconds{300},
+                  VI_ERROR_TMO);
+  profiler.RecordBytes("AgSsa_viRead", 64);
+  profiler.Record("AgSsa_SystemWriteString", std::chrono::nanoseconds{50},
+                  VI_SUCCESS);
+  const auto snapshot = profiler.Snapshot();
+  CHECK(snapshot.size() == 2);
+  for (const auto &statistics : snapshot) {
+    if (statistics.Function != "AgSsa_viRead") continue;
+    CHECK(statistics.Calls == 2);
+    CHECK(statistics.Errors == 1);
+    CHECK(statistics.LastError == VI_ERROR_TMO);
+    CHECK(statistics.Bytes == 64);
+    CHECK(statistics.TotalNanoseconds == 400);
+    CHECK(statistics.MinNanoseconds == 100);
+    CHECK(statistics.MaxNanoseconds == 300);
+    CHECK(statistics.Latency.TotalCount() == 2);
+  }
+  std::ostringstream stream{};
+  profiler.Export(stream);
+  const auto csv = stream.str();
+  CHECK(csv.rfind("function,calls,errors,bytes,total,min,p50,p90,p99,max\n",
+                  0) == 0);
+  CHECK(csv.find("AgSsa_viRead,2,1,64,400,100,") != std::string::npos);
+  profiler.Reset();
+  CHECK(profiler.Snapshot().empty());
+}
+
+}  // namespace
+
+int main() {
+  TestHistogramExactBuckets();
+  TestHistogramResolution();
+  TestHistogramPercentiles();
+  TestProfiler();
+  return Test::Result();
+}
@@ -0,0 +1,133 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "ivi_result_log.h"
+#include "test.h"
+
+namespace {
+
+struct CRecord {
+  ViReal64 Frequency{};
+  ViReal64 Amplitude{};
+};
+
+const std::string g_Path{"test_result_log.bin"};
+
+void TestWriteAndRead() {
+  std::remove(g_Path.c_str());
+  const auto begin = std::chrono::system_clock::now();
+  {
+    CIviResultLogWriter<CRecord> writer{};
+    CHECK(writer.Append(CRecord{}) == VI_ERROR_INV_OBJECT);
+    CHECK(writer.Open(g_Path) == VI_SUCCESS);
+    CHECK(writer.NextSequence() == 0);
+    const std::vector<CRecord> sweep{{1e6, -60.0}, {2e6, -50.0}};
+    CHECK(writer.Append(sweep) == VI_SUCCESS);
+    CHECK(writer.Append(CRecord{3e6, -40.0}) == VI_SUCCESS);
+    CHECK(writer.NextSequence() == 2);
+  }
+  // Reopening continues the sequence.
+  {
+    CIviResultLogWriter<CRecord> writer{};
+    CHECK(writer.Open(g_Path) == VI_SUCCESS);
+    CHECK(writer.NextSequence() == 2);
+    CHECK(writer.Append(CRecord{4e6, -30.0}) == VI_SUCCESS);
+    CHECK(writer.Flush() == VI_SUCCESS);
+  }
+  CIviResultLogReader<CRecord> reader{};
+  CHECK(reader.Open(g_Path) == VI_SUCCESS);
+  CHECK(reader.Size() == 4);
+  CHECK((reader.GetEntry(0).Sequence == 0) &&
+        (reader.GetEntry(1).Sequence == 0) &&
+        (reader.GetEntry(2).Sequence == 1) &&
+        (reader.GetEntry(3).Sequence == 2));
+  CHECK(reader.GetRecord(1).Frequency == 2e6);
+  CHECK(reader.GetRecord(3).Amplitude == -30.0);
+  bool isOrdered{true};
+  for (std::size_t idx{1}; idx < reader.Size(); ++idx) {
+    isOrdered = isOrdered &&
+                (reader.GetEntry(idx - 1).Timestamp <=
+                 reader.GetEntry(idx).Timestamp);
+  }
+  CHECK(isOrdered);
+  CHECK(reader.FindSequence(1) == 2);
+  CHECK(reader.FindSequence(5) == 4);
+  CHECK(reader.FindTime(begin) == 0);
+  CHECK(reader.FindTime(begin + std::chrono::hours{1}) == 4);
+}
+
+void TestRecordSizeMismatch() {
+  struct CWideRecord {
+    ViReal64 Values[3]{};
+  };
+  CIviResultLogWriter<CWideRecord> writer{};
+  CHECK(writer.Open(g_Path) == VI_ERROR_INV_SETUP);
+  CHECK(!writer.IsOpen());
+  CIviResultLogReader<CWideRecord> reader{};
+  CHECK(reader.Open(g_Path) == VI_ERROR_INV_SETUP);
+  CHECK(!reader.IsOpen());
+}
+
+// A torn last entry is not visible to the reader and is overwritten.
+void TestPartialEntry() {
+  {
+    std::FILE *file{std::fopen(g_Path.c_str(), "ab")};
+    const char garbage[5]{};
+    std::fwrite(garbage, sizeof(garbage), 1, file);
+    std::fclose(file);
+  }
+  {
+    CIviResultLogReader<CRecord> reader{};
+    CHECK(reader.Open(g_Path) == VI_SUCCESS);
+    CHECK(reader.Size() == 4);
+  }
+  {
+    CIviResultLogWriter<CRecord> writer{};
+    CHECK(writer.Open(g_Path) == VI_SUCCESS);
+    CHECK(writer.NextSequence() == 3);
+    CHECK(writer.Append(CRecord{5e6, -20.0}) == VI_SUCCESS);
+  }
+  CIviResultLogReader<CRecord> reader{};
+  CHECK(reader.Open(g_Path) == VI_SUCCESS);
+  CHECK(reader.Size() == 5);
+  CHECK(reader.GetRecord(4).Frequency == 5e6);
+  reader.Close();
+  std::remove(g_Path.c_str());
+}
+
+}  // namespace
+
+int main() {
+  TestWriteAndRead();
+  TestRecordSizeMismatch();
+  TestPartialEntry();
+  return Test::Result();
+}
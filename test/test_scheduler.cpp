@@ -0,0 +1,145 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+#include "agxsan_wrapper.h"
+#include "ivi_scheduler.h"
+#include "stub_backend.h"
+#include "test.h"
+
+namespace {
+
+namespace Types = AgXSAn::SA::SpuriousEmissions::Types;
+
+using ClockType = CIviSweepScheduler::ClockType;
+using std::chrono::milliseconds;
+
+bool IsNear(double value, double expected) {
+  return std::abs(value - expected) < 1e-9;
+}
+
+bool IsNear(ClockType::duration value, ClockType::duration expected) {
+  return std::chrono::abs(value - expected) < std::chrono::microseconds{1};
+}
+
+void TestLearning() {
+  CIviSweepScheduler scheduler{0.5, 0.1};
+  const milliseconds expected{100};
+  CHECK(IsNear(scheduler.Predict(expected), expected));
+  CHECK(IsNear(scheduler.WakeUp(expected), milliseconds{90}));
+  // Took 1.2 times the instrument's estimate.
+  scheduler.Observe(expected, milliseconds{120}, milliseconds{30}, false);
+  CHECK(IsNear(scheduler.GetCorrection(), 1.1));
+  CHECK(IsNear(scheduler.Predict(expected), milliseconds{110}));
+  CHECK(IsNear(scheduler.WakeUp(expected), milliseconds{99}));
+  // Complete before the wake up at 99 ms: the sample is pulled in by the
+  // guard, 0.99 * 0.9.
+  scheduler.Observe(expected, milliseconds{99}, milliseconds{0}, true);
+  CHECK(IsNear(scheduler.GetCorrection(), 1.1 + 0.5 * (0.891 - 1.1)));
+  // No estimate, nothing to learn from.
+  const auto correction = scheduler.GetCorrection();
+  scheduler.Observe(milliseconds{0}, milliseconds{50}, milliseconds{5}, false);
+  CHECK(scheduler.GetCorrection() == correction);
+  const auto &statistics = scheduler.GetStatistics();
+  CHECK(statistics.Runs == 3);
+  CHECK(statistics.LateRuns == 1);
+  CHECK(statistics.Idle == milliseconds{35});
+  // A steady ratio is converged to.
+  for (int idx{}; idx < 60; ++idx) {
+    scheduler.Observe(expected, milliseconds{150}, milliseconds{}, false);
+  }
+  CHECK(IsNear(scheduler.GetCorrection(), 1.5));
+  scheduler.Reset();
+  CHECK(scheduler.GetCorrection() == 1.0);
+  CHECK(scheduler.GetStatistics().Runs == 0);
+}
+
+// Enabled ranges 1 and 2 take 20 ms and 30 ms per sweep.
+std::string MakeSweepTimeReply() {
+  std::string enabled{"1,1"};
+  std::string sweepTimes{"0.02,0.03"};
+  for (int idx{2}; idx < Types::AgXSAnConstatns::RangeTableMax; ++idx) {
+    enabled += ",0";
+    sweepTimes += ",0.5";
+  }
+  return enabled + ';' + sweepTimes + '\n';
+}
+
+void TestReadSpuriousResults() {
+  Stub::Reset();
+  AgXSAn::CAgXSAn xsan{};
+  CHECK(xsan.Connect("TCPIP0::xsan::INSTR", AgXSAn::CAgXSAnOptions{}) ==
+        VI_SUCCESS);
+  const auto spurs = Stub::GenerateSpurs(20, 3);
+  Stub::Backend().Trace = Stub::MakeSpuriousTrace(spurs);
+  const auto &spuriousEmissions = xsan.SA.SpuriousEmissions;
+  CIviSweepScheduler scheduler{0.5, 0.1};
+  const milliseconds expected{50};
+  // The sweep is already over at the wake up: a late run.
+  Stub::Backend().Replies = {MakeSweepTimeReply(), "+0\n", "+1\n"};
+  Types::CSpursData spursData{};
+  auto start = ClockType::now();
+  CHECK(spuriousEmissions.ReadSpuriousResults(scheduler, spursData,
+                                              milliseconds{1000}) ==
+        VI_SUCCESS);
+  CHECK(ClockType::now() - start >= scheduler.WakeUp(expected));
+  CHECK(spursData.size() == spurs.size());
+  CHECK(spursData.back().Frequency == spurs.back().Frequency);
+  CHECK(scheduler.GetStatistics().Runs == 1);
+  CHECK(scheduler.GetStatistics().LateRuns == 1);
+  CHECK(scheduler.GetCorrection() < 1.0);
+  // Still sweeping at the wake up: waited for and not late.
+  Stub::Backend().Replies = {MakeSweepTimeReply(), "+0\n", "+0\n"};
+  spursData.clear();
+  start = ClockType::now();
+  CHECK(spuriousEmissions.ReadSpuriousResults(scheduler, spursData,
+                                              milliseconds{1000}) ==
+        VI_SUCCESS);
+  CHECK(ClockType::now() - start >= scheduler.WakeUp(expected));
+  CHECK(spursData.size() == spurs.size());
+  CHECK(scheduler.GetStatistics().Runs == 2);
+  CHECK(scheduler.GetStatistics().LateRuns == 1);
+  // The wait failing is reported.
+  Stub::Backend().Replies = {MakeSweepTimeReply(), "+0\n", "+0\n"};
+  Stub::Backend().FailFunction = "AgXSAn_SystemWaitForOperationComplete";
+  Stub::Backend().FailStatus = VI_ERROR_TMO;
+  CHECK(spuriousEmissions.ReadSpuriousResults(scheduler, spursData,
+                                              milliseconds{1000}) ==
+        VI_ERROR_TMO);
+  CHECK(scheduler.GetStatistics().Runs == 2);
+  xsan.Close();
+}
+
+}  // namespace
+
+int main() {
+  TestLearning();
+  TestReadSpuriousResults();
+  return Test::Result();
+}
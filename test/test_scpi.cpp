@@ -0,0 +1,247 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <array>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ivi_scpi.h"
+#include "test.h"
+
+namespace {
+
+// Serves data in chunks of at most chunkMax bytes, like viRead.
+struct CChunkedReader {
+  std::string Data{};
+  std::size_t ChunkMax{};
+  std::size_t Pos{};
+
+  ViStatus operator()(ViChar *buf, ViInt64 size, ViInt64 *retSize) {
+    const auto chunk =
+        std::min({std::size_t(size), ChunkMax, Data.size() - Pos});
+    std::memcpy(buf, Data.data() + Pos, chunk);
+    Pos += chunk;
+    *retSize = ViInt64(chunk);
+    return (Pos < Data.size()) ? VI_SUCCESS_MAX_CNT : VI_SUCCESS;
+  }
+};
+
+// As above, but with the termination character enabled: a read also stops
+// after a '\n', with VI_SUCCESS_TERM_CHAR unless it is the last byte.
+struct CTermCharReader : CChunkedReader {
+  ViStatus operator()(ViChar *buf, ViInt64 size, ViInt64 *retSize) {
+    auto chunk = std::min({std::size_t(size), ChunkMax, Data.size() - Pos});
+    const auto termChar = Data.find('\n', Pos);
+    if (termChar < Pos + chunk) chunk = termChar - Pos + 1;
+    std::memcpy(buf, Data.data() + Pos, chunk);
+    Pos += chunk;
+    *retSize = ViInt64(chunk);
+    if (Pos == Data.size()) return VI_SUCCESS;
+    return (Data[Pos - 1] == '\n') ? VI_SUCCESS_TERM_CHAR : VI_SUCCESS_MAX_CNT;
+  }
+};
+
+std::vector<ViReal64> ParseList(const std::string &data,
+                                std::size_t chunkSize, ViStatus &status) {
+  std::vector<ViReal64> values{};
+  auto sink = [&values](ViReal64 value) {
+    values.push_back(value);
+    return ViStatus{VI_SUCCESS};
+  };
+  Scpi::CScpiRealListParser parser{};
+  status = VI_SUCCESS;
+  for (std::size_t pos{}; (pos < data.size()) && (status == VI_SUCCESS);
+       pos += chunkSize) {
+    status = parser.Consume(data.data() + pos,
+                            std::min(chunkSize, data.size() - pos), sink);
+  }
+  if (status == VI_SUCCESS) status = parser.Finish(sink);
+  return values;
+}
+
+void TestListParser() {
+  const std::string list{"+1.5E+09,-2.25E+01,3;4,\t5\n"};
+  const std::vector<ViReal64> expected{1.5e9, -22.5, 3, 4, 5};
+  // Every chunking, including tokens split across chunks, gives the same.
+  for (std::size_t chunkSize{1}; chunkSize <= list.size(); ++chunkSize) {
+    ViStatus status{};
+    CHECK(ParseList(list, chunkSize, status) == expected);
+    CHECK(status == VI_SUCCESS);
+  }
+  ViStatus status{};
+  CHECK(ParseList("", 4, status).empty());
+  CHECK(status == VI_SUCCESS);
+  ParseList("1,abc,3", 2, status);
+  CHECK(status == VI_ERROR_INV_RESPONSE);
+  ParseList(std::string(100, '1'), 7, status);
+  CHECK(status == VI_ERROR_INV_RESPONSE);
+}
+
+void TestBlockReader() {
+  const std::array<ViReal64, 3> values{1.0, -2.0, 3.5};
+  std::string block{"#224"};
+  block.append(reinterpret_cast<const char *>(values.data()), 24);
+  block += '\n';
+  for (std::size_t chunkSize : {1, 3, 64}) {
+    CChunkedReader reader{block, chunkSize};
+    std::array<ViReal64, 3> data{};
+    std::size_t length{};
+    auto status = Scpi::ReadDefiniteLengthBlock(
+        reader, [&data, &length](std::size_t size) {
+          length = size;
+          return reinterpret_cast<ViChar *>(data.data());
+        });
+    CHECK(status == VI_SUCCESS);
+    CHECK(length == 24);
+    CHECK(data == values);
+    CHECK(reader.Pos == block.size());
+  }
+  // 0x0A bytes in the payload look like terminators to VISA.
+  std::string lfBlock{"#18"};
+  lfBlock.append("\x0a\x01\x0a\x0a\x02\x03\x04\x0a");
+  std::string trailer{lfBlock + "\n"};
+  for (std::size_t chunkSize : {1, 3, 64}) {
+    CTermCharReader reader{};
+    reader.Data = trailer;
+    reader.ChunkMax = chunkSize;
+    std::array<ViChar, 8> data{};
+    auto status = Scpi::ReadDefiniteLengthBlock(
+        reader, [&data](std::size_t) { return data.data(); });
+    CHECK(status == VI_SUCCESS);
+    CHECK(std::string_view(data.data(), data.size()) == lfBlock.substr(3));
+    CHECK(reader.Pos == trailer.size());
+  }
+  // The trailing terminator stopping the read without END is fine too.
+  CTermCharReader reader{};
+  reader.Data = trailer + "#10\n";
+  reader.ChunkMax = 64;
+  std::array<ViChar, 8> data{};
+  CHECK(Scpi::ReadDefiniteLengthBlock(reader, [&data](std::size_t) {
+          return data.data();
+        }) == VI_SUCCESS);
+  CHECK(reader.Pos == trailer.size());
+  auto read = [](const std::string &data, bool isAccepted) {
+    CChunkedReader reader{data, 64};
+    std::array<ViChar, 16> storage{};
+    return Scpi::ReadDefiniteLengthBlock(reader, [&](std::size_t) {
+      return isAccepted ? storage.data() : nullptr;
+    });
+  };
+  CHECK(read("#10\n", true) == VI_SUCCESS);
+  CHECK(read("#14abcd\n", false) == VI_ERROR_INV_RESPONSE);
+  CHECK(read("#04abcd\n", true) == VI_ERROR_INV_RESPONSE);
+  CHECK(read("14abcd\n", true) == VI_ERROR_INV_RESPONSE);
+  CHECK(read("#18abcd", true) == VI_ERROR_INV_RESPONSE);
+}
+
+void TestReadResponse() {
+  CChunkedReader reader{"+1;+0,\"No error\"\n", 5};
+  std::array<ViChar, 8> response{};
+  std::size_t responseSize{};
+  // What does not fit is dropped, but still read.
+  CHECK(Scpi::ReadResponse(reader, response, responseSize) == VI_SUCCESS);
+  CHECK(std::string_view(response.data(), responseSize) == "+1;+0,\"N");
+  CHECK(reader.Pos == reader.Data.size());
+  CChunkedReader longReader{std::string(3000, 'x'), 700};
+  std::string longResponse{};
+  CHECK(Scpi::ReadResponse(longReader, longResponse) == VI_SUCCESS);
+  CHECK(longResponse == longReader.Data);
+}
+
+void TestErrorResponse() {
+  ViInt32 code{};
+  std::string_view description{};
+  const std::string_view error{"-113,\"Undefined header\"\n"};
+  CHECK(Scpi::ParseErrorResponse(error.data(), error.size(), code,
+                                 description) == VI_SUCCESS);
+  CHECK(code == -113);
+  CHECK(description == "Undefined header");
+  const std::string_view none{"+0,\"No error\""};
+  CHECK(Scpi::ParseErrorResponse(none.data(), none.size(), code,
+                                 description) == VI_SUCCESS);
+  CHECK(code == 0);
+  const std::string_view garbage{"error"};
+  CHECK(Scpi::ParseErrorResponse(garbage.data(), garbage.size(), code,
+                                 description) == VI_ERROR_INV_RESPONSE);
+}
+
+void TestBatchResponse() {
+  auto parse = [](std::string_view response, ViInt32 &code) {
+    std::string_view description{};
+    return Scpi::ParseBatchResponse(response.data(), response.size(), code,
+                                    description);
+  };
+  ViInt32 code{-1};
+  CHECK(parse("1;0,\"No error\"\n", code) == VI_SUCCESS);
+  CHECK(code == 0);
+  CHECK(parse("+1;-222,\"Data out of range\"\n", code) == VI_SUCCESS);
+  CHECK(code == -222);
+  // The *OPC? field must be 1.
+  CHECK(parse("0;0,\"No error\"\n", code) == VI_ERROR_INV_RESPONSE);
+  CHECK(parse(";0,\"No error\"\n", code) == VI_ERROR_INV_RESPONSE);
+  CHECK(parse("1x;0,\"No error\"\n", code) == VI_ERROR_INV_RESPONSE);
+  CHECK(parse("0,\"No error\"\n", code) == VI_ERROR_INV_RESPONSE);
+}
+
+void TestBatch() {
+  Scpi::CScpiBatch batch{};
+  CHECK(batch.IsEmpty());
+  CHECK(std::string_view(batch.Message()) == "*OPC?;:SYST:ERR?");
+  batch.Add("INIT:CONT OFF").Add(":SENS:FREQ:CENT", 1.5e9).Add("*SAV", 3);
+  batch.Add(":DISP:FSCR", true).Add("");
+  CHECK(batch.Size() == 4);
+  CHECK(std::string_view(batch.Message()) ==
+        ":INIT:CONT OFF;:SENS:FREQ:CENT 1.5e+09;*SAV 3;:DISP:FSCR 1;"
+        "*OPC?;:SYST:ERR?");
+  batch.Clear();
+  CHECK(batch.IsEmpty());
+  CHECK(std::string_view(batch.Message()) == "*OPC?;:SYST:ERR?");
+}
+
+void TestCommand() {
+  static constexpr auto query{Scpi::Command(
+      ":CALC:PN", Scpi::Index<2>(), ":TRAC", Scpi::Index<12>(), ":SPUR?")};
+  static_assert(query.View() == ":CALC:PN2:TRAC12:SPUR?");
+  CHECK(std::string_view(query.c_str()) == ":CALC:PN2:TRAC12:SPUR?");
+  ViInt32 value{};
+  CHECK(Scpi::ParseInteger("+36\r\n", 5, value) == VI_SUCCESS);
+  CHECK(value == 36);
+  CHECK(Scpi::ParseInteger("3x", 2, value) == VI_ERROR_INV_RESPONSE);
+}
+
+}  // namespace
+
+int main() {
+  TestListParser();
+  TestBlockReader();
+  TestReadResponse();
+  TestErrorResponse();
+  TestBatchResponse();
+  TestBatch();
+  TestCommand();
+  return Test::Result();
+}
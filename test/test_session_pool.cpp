@@ -0,0 +1,189 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "agssa_wrapper.h"
+#include "ivi_session_pool.h"
+#include "stub_backend.h"
+#include "test.h"
+
+namespace {
+
+struct COptions {
+  int Mode{};
+  bool operator==(const COptions &other) const noexcept {
+    return Mode == other.Mode;
+  }
+};
+
+// Counts connections across every instance; slow connects expose whether
+// the pool brings a rack up in parallel.
+struct CInstrument {
+  inline static std::atomic<int> Connects{};
+  inline static std::atomic<int> Closes{};
+  inline static std::atomic<ViStatus> CheckStatus{VI_SUCCESS};
+  inline static std::chrono::milliseconds ConnectDelay{};
+  bool IsConnected{};
+
+  static void Reset() {
+    Connects = 0;
+    Closes = 0;
+    CheckStatus = VI_SUCCESS;
+    ConnectDelay = std::chrono::milliseconds{};
+  }
+  ViStatus Connect(const std::string &resource, const COptions &) {
+    std::this_thread::sleep_for(ConnectDelay);
+    ++Connects;
+    if (resource == "BAD") return VI_ERROR_RSRC_NFOUND;
+    IsConnected = true;
+    return VI_SUCCESS;
+  }
+  void Close() {
+    ++Closes;
+    IsConnected = false;
+  }
+  bool IsOpen() const { return IsConnected; }
+  ViStatus CheckConnection() { return CheckStatus; }
+};
+
+using CPool = CIviSessionPool<CInstrument, COptions>;
+
+void TestReuse() {
+  CInstrument::Reset();
+  {
+    CPool pool{};
+    CPool::CLease lease{};
+    CHECK(pool.Acquire("A", COptions{}, lease) == VI_SUCCESS);
+    CHECK(lease && lease->IsOpen());
+    lease.Release();
+    CHECK(!lease);
+    CHECK(pool.Acquire("A", COptions{}, lease) == VI_SUCCESS);
+    CHECK(CInstrument::Connects == 1);
+    const auto statistics = pool.GetStatistics();
+    CHECK(statistics.Connects == 1);
+    CHECK(statistics.Reuses == 1);
+    CHECK(statistics.Reconnects == 0);
+  }
+  // The lease went out of scope first, so the pool closed the session.
+  CHECK(CInstrument::Closes == 1);
+}
+
+void TestReconnect() {
+  CInstrument::Reset();
+  CPool pool{};
+  CPool::CLease lease{};
+  CHECK(pool.Acquire("A", COptions{}, lease) == VI_SUCCESS);
+  lease.Release();
+  CHECK(pool.Acquire("A", COptions{1}, lease) == VI_SUCCESS);
+  lease.Release();
+  CInstrument::CheckStatus = VI_ERROR_CONN_LOST;
+  CHECK(pool.Acquire("A", COptions{1}, lease) == VI_SUCCESS);
+  CHECK(CInstrument::Connects == 3);
+  CHECK(CInstrument::Closes == 2);
+  CHECK(pool.GetStatistics().Reconnects == 2);
+}
+
+void TestLocked() {
+  CInstrument::Reset();
+  CPool pool{};
+  CPool::CLease lease{};
+  CPool::CLease other{};
+  CHECK(pool.Acquire("A", COptions{}, lease) == VI_SUCCESS);
+  CHECK(pool.Acquire("A", COptions{}, other) == VI_ERROR_RSRC_LOCKED);
+  CHECK(!other);
+  CHECK(pool.Acquire("B", COptions{}, other) == VI_SUCCESS);
+  other = std::move(lease);
+  CHECK(pool.Acquire("B", COptions{}, lease) == VI_SUCCESS);
+  // Close leaves leased sessions open.
+  pool.Close();
+  CHECK(CInstrument::Closes == 0);
+}
+
+void TestFailedConnect() {
+  CInstrument::Reset();
+  CPool pool{};
+  CPool::CLease lease{};
+  CHECK(pool.Acquire("BAD", COptions{}, lease) == VI_ERROR_RSRC_NFOUND);
+  CHECK(!lease);
+  CHECK(CInstrument::Closes == 1);
+  // The failed entry is not left leased.
+  CHECK(pool.Acquire("BAD", COptions{}, lease) == VI_ERROR_RSRC_NFOUND);
+}
+
+void TestConnect() {
+  CInstrument::Reset();
+  CInstrument::ConnectDelay = std::chrono::milliseconds{100};
+  CPool pool{};
+  const auto start = std::chrono::steady_clock::now();
+  CHECK(pool.Connect({{"A", {}}, {"B", {}}, {"A", {}}, {"C", {}}}) ==
+        VI_SUCCESS);
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  CHECK(CInstrument::Connects == 3);
+  CHECK(elapsed < std::chrono::milliseconds{250});
+  CInstrument::ConnectDelay = std::chrono::milliseconds{};
+  CPool::CLease lease{};
+  CHECK(pool.Acquire("B", COptions{}, lease) == VI_SUCCESS);
+  CHECK(pool.GetStatistics().Reuses == 1);
+  CHECK(pool.Connect({{"D", {}}, {"D", {1}}}) == VI_ERROR_INV_SETUP);
+  CHECK(CInstrument::Connects == 3);
+  CHECK(pool.Connect({{"E", {}}, {"BAD", {}}}) == VI_ERROR_RSRC_NFOUND);
+}
+
+void TestAgSsa() {
+  Stub::Reset();
+  {
+    CIviSessionPool<AgSsa::CAgSsa, AgSsa::CAgSsaOptions> pool{};
+    decltype(pool)::CLease lease{};
+    const AgSsa::CAgSsaOptions options{};
+    CHECK(pool.Acquire("TCPIP0::ssa::INSTR", options, lease) == VI_SUCCESS);
+    CHECK(lease->IsOpen());
+    lease.Release();
+    CHECK(pool.Acquire("TCPIP0::ssa::INSTR", options, lease) == VI_SUCCESS);
+    CHECK(Stub::Backend().Connects == 1);
+    lease.Release();
+    Stub::Backend().StatusByteStatus = VI_ERROR_CONN_LOST;
+    CHECK(pool.Acquire("TCPIP0::ssa::INSTR", options, lease) == VI_SUCCESS);
+    CHECK(Stub::Backend().Connects == 2);
+    CHECK(Stub::Backend().Closes == 1);
+  }
+  CHECK(Stub::Backend().Closes == 2);
+}
+
+}  // namespace
+
+int main() {
+  TestReuse();
+  TestReconnect();
+  TestLocked();
+  TestFailedConnect();
+  TestConnect();
+  TestAgSsa();
+  return Test::Result();
+}
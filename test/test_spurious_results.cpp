@@ -0,0 +1,100 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "agxsan_wrapper.h"
+#include "ivi_spurs.h"
+#include "stub_backend.h"
+#include "test.h"
+
+namespace {
+
+namespace Types = AgXSAn::SA::SpuriousEmissions::Types;
+
+constexpr std::uint32_t SpursSeed{11};
+
+template <typename Spurs>
+bool IsEqual(const Spurs &results, const std::vector<Stub::CSpur> &spurs) {
+  if (results.size() != spurs.size()) return false;
+  for (std::size_t idx{}; idx < spurs.size(); ++idx) {
+    if ((results[idx].Number != ViReal64(idx + 1)) ||
+        (results[idx].Frequency != spurs[idx].Frequency) ||
+        (results[idx].Amplitude != spurs[idx].Amplitude)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Fits the first fetch buffer, fills it exactly and needs it grown twice.
+void TestFetchView() {
+  Stub::Reset();
+  AgXSAn::CAgXSAn xsan{};
+  CHECK(xsan.Connect("TCPIP0::xsan::INSTR", AgXSAn::CAgXSAnOptions{}) ==
+        VI_SUCCESS);
+  const auto &trace = xsan.SA.SpuriousEmissions.Trace;
+  for (const std::size_t spursNum : {0, 3, 256, 1000, 5}) {
+    const auto spurs = Stub::GenerateSpurs(spursNum, SpursSeed);
+    Stub::Backend().Trace = Stub::MakeSpuriousTrace(spurs);
+    Types::CSpursView spursView{};
+    CHECK(trace.FetchSpuriousResults(spursView) == VI_SUCCESS);
+    CHECK(IsEqual(spursView, spurs));
+  }
+  xsan.Close();
+}
+
+void TestFetchCopies() {
+  Stub::Reset();
+  AgXSAn::CAgXSAn xsan{};
+  CHECK(xsan.Connect("TCPIP0::xsan::INSTR", AgXSAn::CAgXSAnOptions{}) ==
+        VI_SUCCESS);
+  const auto &trace = xsan.SA.SpuriousEmissions.Trace;
+  const auto spurs = Stub::GenerateSpurs(300, SpursSeed);
+  Stub::Backend().Trace = Stub::MakeSpuriousTrace(spurs);
+  Types::CSpursData spursData{};
+  CHECK(trace.FetchSpuriousResults(spursData) == VI_SUCCESS);
+  CHECK(IsEqual(spursData, spurs));
+  // Appends to what the caller already holds.
+  CHECK(trace.FetchSpuriousResults(spursData) == VI_SUCCESS);
+  CHECK(spursData.size() == 2 * spurs.size());
+  Spurs::CSpursColumns spursColumns{};
+  CHECK(trace.FetchSpuriousResults(spursColumns) == VI_SUCCESS);
+  CHECK(spursColumns.size() == spurs.size());
+  CHECK(spursColumns.Frequency.back() == spurs.back().Frequency);
+  CHECK(spursColumns.Amplitude.back() == spurs.back().Amplitude);
+  CHECK(spursColumns.Limit.back() == -30.0);
+  xsan.Close();
+}
+
+}  // namespace
+
+int main() {
+  TestFetchView();
+  TestFetchCopies();
+  return Test::Result();
+}
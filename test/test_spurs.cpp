@@ -0,0 +1,138 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "ivi_spurs.h"
+#include "test.h"
+
+namespace {
+
+struct CSpur {
+  ViReal64 Frequency{};
+  ViReal64 Amplitude{};
+  ViReal64 Limit{};
+};
+
+std::vector<Spurs::CSpurChange> Update(Spurs::CSpurTracker &tracker,
+                                       const std::vector<CSpur> &spurs) {
+  std::vector<Spurs::CSpurChange> changes{};
+  CHECK(tracker.Update(spurs, [&changes](const Spurs::CSpurChange &change) {
+    changes.push_back(change);
+  }) == VI_SUCCESS);
+  return changes;
+}
+
+void TestTrackerMerge() {
+  using Spurs::SpurEvent;
+  Spurs::CSpurTracker tracker{1e3, 1.0, 100.0};
+  // Unsorted input is sorted by frequency before the merge.
+  auto changes = Update(tracker, {{2e6, -50.0}, {1e6, -60.0}});
+  CHECK(changes.size() == 2);
+  CHECK((changes[0].Event == SpurEvent::Appeared) &&
+        (changes[0].Frequency == 1e6));
+  CHECK((changes[1].Event == SpurEvent::Appeared) &&
+        (changes[1].Frequency == 2e6));
+  CHECK(tracker.size() == 2);
+  // Jitter below the thresholds stays quiet.
+  CHECK(Update(tracker, {{1e6 + 50.0, -60.5}, {2e6, -50.0}}).empty());
+  // Moved, amplitude change, one gone and one new.
+  changes = Update(tracker, {{1e6 + 600.0, -60.5}, {3e6, -40.0}});
+  CHECK(changes.size() == 3);
+  CHECK((changes[0].Event == SpurEvent::Moved) &&
+        (changes[0].Frequency == 1e6 + 600.0) &&
+        (changes[0].PreviousFrequency == 1e6 + 50.0));
+  CHECK((changes[1].Event == SpurEvent::Disappeared) &&
+        (changes[1].Frequency == 2e6));
+  CHECK((changes[2].Event == SpurEvent::Appeared) &&
+        (changes[2].Frequency == 3e6));
+  changes = Update(tracker, {{1e6 + 600.0, -55.0}, {3e6, -40.0}});
+  CHECK(changes.size() == 1);
+  CHECK((changes[0].Event == SpurEvent::AmplitudeChanged) &&
+        (changes[0].Amplitude == -55.0) &&
+        (changes[0].PreviousAmplitude == -60.5));
+  changes = Update(tracker, {});
+  CHECK(changes.size() == 2);
+  CHECK(tracker.size() == 0);
+  tracker.Reset();
+  CHECK(Update(tracker, {{5e6, -70.0}}).size() == 1);
+}
+
+// Sizes around the vector width exercise both the SIMD body and the tail.
+void TestLimitKernels() {
+  for (std::size_t size : {0, 1, 3, 4, 5, 9, 17}) {
+    Spurs::CSpursColumns spurs{};
+    std::vector<CSpur> records(size);
+    for (std::size_t idx{}; idx < size; ++idx) {
+      records[idx] = CSpur{1e6 * ViReal64(idx), -60.0 + ViReal64(idx % 4),
+                           -55.0};
+    }
+    if (size > 2) records[size - 2].Amplitude = -50.0;
+    spurs.Append(records.data(), records.size());
+    CHECK(spurs.size() == size);
+    std::vector<ViReal64> margin{};
+    Spurs::ComputeMargin(spurs, margin);
+    bool isMarginRight{margin.size() == size};
+    for (std::size_t idx{}; isMarginRight && (idx < size); ++idx) {
+      isMarginRight = (margin[idx] == records[idx].Limit -
+                                          records[idx].Amplitude);
+    }
+    CHECK(isMarginRight);
+    const auto worst = Spurs::FindWorstMargin(spurs);
+    if (size == 0) {
+      CHECK(std::isinf(worst.Margin));
+    } else if (size > 2) {
+      CHECK((worst.Index == size - 2) && (worst.Margin == -5.0));
+    } else {
+      CHECK((worst.Index == 0) && (worst.Margin == 5.0));
+    }
+    std::vector<std::uint8_t> mask{};
+    CHECK(Spurs::ComputePassMask(spurs, mask) == ((size > 2) ? 1U : 0U));
+  }
+  // The first NaN is the worst margin and fails the mask.
+  Spurs::CSpursColumns spurs{};
+  const std::vector<CSpur> records{
+      {1.0, -60.0, -50.0}, {2.0, -40.0, -50.0},
+      {3.0, std::numeric_limits<ViReal64>::quiet_NaN(), -50.0},
+      {4.0, -60.0, -50.0}, {5.0, -60.0, -50.0}};
+  spurs.Append(records.data(), records.size());
+  const auto worst = Spurs::FindWorstMargin(spurs);
+  CHECK((worst.Index == 2) && std::isnan(worst.Margin));
+  std::vector<std::uint8_t> mask{};
+  CHECK(Spurs::ComputePassMask(spurs, mask) == 2);
+  CHECK((mask[0] == 1) && (mask[1] == 0) && (mask[2] == 0));
+}
+
+}  // namespace
+
+int main() {
+  TestTrackerMerge();
+  TestLimitKernels();
+  return Test::Result();
+}
@@ -0,0 +1,108 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <string>
+#include <vector>
+
+#include "agssa_wrapper.h"
+#include "ivi_scpi.h"
+#include "stub_backend.h"
+#include "test.h"
+
+namespace {
+
+void TestRecord() {
+  Stub::Reset();
+  AgSsa::CAgSsa ssa{};
+  CHECK(ssa.Connect("TCPIP0::ssa::INSTR", AgSsa::CAgSsaOptions{}) ==
+        VI_SUCCESS);
+  Scpi::CScpiBatch batch{};
+  auto status = ssa.System.Record(batch, [&] {
+    auto status = ssa.Display.ConfigureMaximize();
+    if (status != VI_SUCCESS) return status;
+    return ssa.Application.PN.Aquisition.ConfigureCorrelation(16);
+  });
+  CHECK(status == VI_SUCCESS);
+  CHECK(batch.Size() == 2);
+  CHECK(std::string{batch.Message()} ==
+        ":DISP:MAX 1;:SENS:PN1:CORR:COUN 16;*OPC?;:SYST:ERR?");
+  CHECK(Stub::Backend().AttributeWrites == 0);
+  // A setting without a SCPI header cannot be recorded.
+  batch.Clear();
+  status = ssa.System.Record(batch, [&] {
+    return ssa.Display.ConfigureActiveWindow(
+        AgSsa::Display::ActiveWindowType::PN1);
+  });
+  CHECK(status == VI_ERROR_NSUP_OPER);
+  CHECK(batch.IsEmpty());
+  // Recording ends with the sequence.
+  CHECK(ssa.Display.ConfigureMaximize() == VI_SUCCESS);
+  CHECK(Stub::Backend().AttributeWrites == 1);
+  ssa.Close();
+}
+
+void TestExecute() {
+  Stub::Reset();
+  AgSsa::CAgSsa ssa{};
+  CHECK(ssa.Connect("TCPIP0::ssa::INSTR", AgSsa::CAgSsaOptions{}) ==
+        VI_SUCCESS);
+  Scpi::CScpiBatch batch{};
+  batch.Add(":DISP:MAX", true);
+  Stub::Backend().Replies = {"1;0,\"No error\"\n"};
+  std::vector<CIviDeferredError> errors{};
+  CHECK(ssa.System.Execute(batch, errors) == VI_SUCCESS);
+  CHECK(errors.empty());
+  CHECK(Stub::Backend().Writes ==
+        std::vector<std::string>{":DISP:MAX 1;*OPC?;:SYST:ERR?"});
+  CHECK(Stub::Backend().Invalidations == 1);
+  // The first error comes with the batch reply, the rest are drained.
+  Stub::Backend().Replies = {"+1;-222,\"Data out of range\"\n",
+                             "-113,\"Undefined header\"\n",
+                             "0,\"No error\"\n"};
+  CHECK(ssa.System.Execute(batch, errors) == VI_SUCCESS);
+  CHECK(errors.size() == 2);
+  if (errors.size() == 2) {
+    CHECK(errors[0].Code == -222);
+    CHECK(errors[0].Description == "Data out of range");
+    CHECK(errors[1].Code == -113);
+  }
+  Stub::Backend().Replies = {"1;-222,\"Data out of range\"\n",
+                             "0,\"No error\"\n"};
+  ViInt32 errorCode{};
+  CHECK(ssa.System.Execute(batch, errorCode) == VI_SUCCESS);
+  CHECK(errorCode == -222);
+  // A reply not completing the *OPC? belongs to something else.
+  Stub::Backend().Replies = {"0;0,\"No error\"\n"};
+  CHECK(ssa.System.Execute(batch, errors) == VI_ERROR_INV_RESPONSE);
+  ssa.Close();
+}
+
+}  // namespace
+
+int main() {
+  TestRecord();
+  TestExecute();
+  return Test::Result();
+}
@@ -0,0 +1,138 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Alexander Chernenko (achernenko@mail.ru)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "ivi_stream.h"
+#include "test.h"
+
+namespace {
+
+void TestRingCapacity() {
+  CIviSpscRing<int> ring{5};
+  CHECK(ring.Capacity() == 8);
+  CHECK(ring.Size() == 0);
+  int value{};
+  CHECK(!ring.TryPop(value));
+  for (int idx{}; idx < 8; ++idx) {
+    value = idx;
+    CHECK(ring.TryPush(value));
+  }
+  value = 8;
+  CHECK(!ring.TryPush(value));
+  CHECK(ring.Size() == 8);
+  for (int idx{}; idx < 8; ++idx) {
+    CHECK(ring.TryPop(value));
+    CHECK(value == idx);
+  }
+  CHECK(!ring.TryPop(value));
+}
+
+// Slots are swapped, so buffers keep cycling instead of being reallocated.
+void TestRingSwapsBuffers() {
+  CIviSpscRing<std::vector<int>> ring{2};
+  std::vector<int> frame(100, 1);
+  const auto *const storage = frame.data();
+  CHECK(ring.TryPush(frame));
+  CHECK(frame.empty());
+  std::vector<int> received{};
+  CHECK(ring.TryPop(received));
+  CHECK(received.size() == 100);
+  CHECK(received.data() == storage);
+}
+
+void TestRingThreads() {
+  constexpr int valuesNum{100000};
+  CIviSpscRing<int> ring{64};
+  std::thread producer{[&ring] {
+    for (int idx{}; idx < valuesNum; ++idx) {
+      int value{idx};
+      while (!ring.TryPush(value)) std::this_thread::yield();
+    }
+  }};
+  bool isOrdered{true};
+  for (int expected{}; expected < valuesNum;) {
+    int value{};
+    if (!ring.TryPop(value)) {
+      std::this_thread::yield();
+      continue;
+    }
+    isOrdered = isOrdered && (value == expected);
+    ++expected;
+  }
+  producer.join();
+  CHECK(isOrdered);
+  CHECK(ring.Size() == 0);
+}
+
+void TestStreamStopsAfterErrors() {
+  CIviStream<int> stream{4, 3};
+  std::atomic<int> calls{};
+  CHECK(stream.Start([&calls](int &) {
+    ++calls;
+    return ViStatus{VI_ERROR_TMO};
+  }) == VI_SUCCESS);
+  while (stream.IsRunning()) std::this_thread::yield();
+  stream.Stop();
+  const auto counters = stream.GetCounters();
+  CHECK(calls == 3);
+  CHECK(counters.Errors == 3);
+  CHECK(counters.LastError == VI_ERROR_TMO);
+  CHECK(counters.Frames == 0);
+}
+
+void TestStreamCountsOverflows() {
+  CIviStream<int> stream{2};
+  std::atomic<int> frame{};
+  CHECK(stream.Start([&frame](int &value) {
+    value = frame++;
+    return ViStatus{VI_SUCCESS};
+  }) == VI_SUCCESS);
+  CHECK(stream.Start([](int &) { return ViStatus{VI_SUCCESS}; }) ==
+        VI_ERROR_IN_PROGRESS);
+  while (frame < 100) std::this_thread::yield();
+  stream.Stop();
+  const auto counters = stream.GetCounters();
+  CHECK(counters.Frames == 2);
+  CHECK(counters.Frames + counters.Overflows == std::uint64_t(frame.load()));
+  int value{-1};
+  CHECK(stream.TryPop(value));
+  CHECK(value == 0);
+}
+
+}  // namespace
+
+int main() {
+  TestRingCapacity();
+  TestRingSwapsBuffers();
+  TestRingThreads();
+  TestStreamStopsAfterErrors();
+  TestStreamCountsOverflows();
+  return Test::Result();
+}